@@ -0,0 +1,333 @@
+/**
+ * Balance runner. Plays many headless games in parallel, each following
+ * a scripted build order, and writes one CSV row per game to standard
+ * output and a summary of outcomes and simulation speed to standard
+ * error.
+ *
+ *   balance [-g GAMES] [-j THREADS] [-d DAYS] [-s SEED] [-b ORDER]
+ *           [-i HOURS] [-c CURVES.csv] [-f]
+ *
+ * ORDER is a string of building letters (W F H M S +) placed one per
+ * interval, in turn and starting over at the end, on the free site
+ * nearest the castle, waiting whenever the next one is unaffordable
+ * and skipping it when it has nowhere to go.
+ * Idle squads are sent after the nearest invader. Game N plays from
+ * random state SEED + N, so any row can be replayed with -g 1. With
+ * -f, worlds are made by the fBm engine instead of diamond-square.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "game.h"
+#include "rand.h"
+
+typedef struct {
+    uint64_t seed;
+    enum game_event outcome; // EVENT_NONE if out of time
+    long time;
+    double gold, food, wood, population;
+    int buildings;
+} result_t;
+
+/* Resources on one day, summed over the games still going. */
+typedef struct {
+    long games;
+    double gold, food, wood, population, buildings;
+} sample_t;
+
+typedef struct {
+    pthread_t thread;
+    sample_t *curve;
+    double days;        // game-days simulated
+    double step_cpu;    // seconds spent in game_step()
+    double generate_cpu; // seconds spent generating worlds
+} worker_t;
+
+static long games = 1000;
+static long days = 60;
+static long interval = 1; // hours
+static uint64_t seed = 1;
+static enum map_engine engine = MAP_DIAMOND_SQUARE;
+static const char *order = "WHFHWHMH";
+static result_t *results;
+static long next;     // next game to claim
+static long finished;
+
+typedef struct {
+    int x, y;
+} site_t;
+
+/* Map cells nearest the castle first. */
+static site_t sites[MAP_WIDTH * MAP_HEIGHT];
+
+static int
+site_cmp(const void *a, const void *b)
+{
+    const site_t *sa = a, *sb = b;
+    const int cx = MAP_WIDTH / 2, cy = MAP_HEIGHT / 2; // the castle
+    int da = (sa->x - cx) * (sa->x - cx) + (sa->y - cy) * (sa->y - cy);
+    int db = (sb->x - cx) * (sb->x - cx) + (sb->y - cy) * (sb->y - cy);
+    if (da != db)
+        return da - db;
+    return sa->x != sb->x ? sa->x - sb->x : sa->y - sb->y;
+}
+
+static double
+cpu_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Place BUILDING on the free site nearest the castle, if it has one.
+ */
+static void
+build(game_t *game, uint16_t building)
+{
+    for (unsigned i = 0; i < countof(sites); i++)
+        if (game_build(game, building, sites[i].x, sites[i].y))
+            return;
+}
+
+static void
+defend(game_t *game)
+{
+    for (unsigned s = 0; s < countof(game->squads); s++) {
+        squad_t *squad = game->squads + s;
+        if (squad->member_count == 0 || squad->target >= 0)
+            continue;
+        float best_d = INFINITY;
+        for (unsigned i = 0; i < countof(game->invaders); i++) {
+            invader_t *invader = game->invaders + i;
+            float dx = invader->x - squad->x;
+            float dy = invader->y - squad->y;
+            if (invader->active && dx * dx + dy * dy < best_d) {
+                best_d = dx * dx + dy * dy;
+                squad->target = i;
+            }
+        }
+    }
+}
+
+static int
+count_buildings(game_t *game)
+{
+    int count = 0;
+    for (int y = 0; y < MAP_HEIGHT; y++)
+        for (int x = 0; x < MAP_WIDTH; x++)
+            count += map_building(game->map, x, y) != C_NONE;
+    return count;
+}
+
+static void
+play(worker_t *w, long n)
+{
+    result_t *r = results + n;
+    r->seed = rand_state = seed + n;
+    double start = cpu_now();
+    game_t *game = game_create(xorshift(&rand_state), engine,
+                                MAP_WIDTH, MAP_HEIGHT);
+    w->generate_cpu += cpu_now() - start;
+
+    start = cpu_now();
+    const char *building = order;
+    long end = days * (long)DAY;
+    while (r->outcome == EVENT_NONE && game->time < end) {
+        if (game->time % (long)DAY == 0) {
+            sample_t *s = w->curve + game->time / (long)DAY;
+            s->games++;
+            s->gold += game->gold;
+            s->food += game->food;
+            s->wood += game->wood;
+            s->population += game->population;
+            s->buildings += count_buildings(game);
+        }
+        if (game->time % (interval * (long)HOUR) == 0) {
+            if (*building &&
+                game_can_afford(game, building_cost(*building))) {
+                build(game, *building);
+                if (!*++building)
+                    building = order;
+            }
+            defend(game);
+        }
+        game_step(game);
+        for (enum game_event e; (e = game_event_pop(game)) != EVENT_NONE;)
+            if (e == EVENT_WIN || e == EVENT_LOSE)
+                r->outcome = e;
+    }
+    w->step_cpu += cpu_now() - start;
+    w->days += game->time / DAY;
+
+    r->time = game->time;
+    r->gold = game->gold;
+    r->food = game->food;
+    r->wood = game->wood;
+    r->population = game->population;
+    r->buildings = count_buildings(game);
+    game_free(game);
+}
+
+static void *
+worker_run(void *arg)
+{
+    worker_t *w = arg;
+    for (long n; (n = __sync_fetch_and_add(&next, 1)) < games;) {
+        play(w, n);
+        __sync_fetch_and_add(&finished, 1);
+    }
+    return NULL;
+}
+
+static int
+days_cmp(const void *a, const void *b)
+{
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-g GAMES] [-j THREADS] [-d DAYS] [-s SEED]"
+            " [-b ORDER] [-i HOURS] [-c CURVES.csv] [-f]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    int threads = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *curves = NULL;
+    for (int option; (option = getopt(argc, argv, "g:j:d:s:b:i:c:f")) != -1;) {
+        switch (option) {
+        case 'g':
+            games = atol(optarg);
+            break;
+        case 'j':
+            threads = atoi(optarg);
+            break;
+        case 'd':
+            days = atol(optarg);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        case 'b':
+            order = optarg;
+            break;
+        case 'i':
+            interval = atol(optarg);
+            break;
+        case 'c':
+            curves = optarg;
+            break;
+        case 'f':
+            engine = MAP_FBM;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind != argc || games < 1 || threads < 1 || days < 1 ||
+        interval < 1 || !*order || order[strspn(order, "WFHMS+")])
+        usage(argv[0]);
+
+    for (int x = 0; x < MAP_WIDTH; x++)
+        for (int y = 0; y < MAP_HEIGHT; y++)
+            sites[x * MAP_HEIGHT + y] = (site_t){x, y};
+    qsort(sites, countof(sites), sizeof(sites[0]), site_cmp);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    results = calloc(games, sizeof(*results));
+    worker_t *workers = calloc(threads, sizeof(*workers));
+    for (int i = 0; i < threads; i++) {
+        workers[i].curve = calloc(days + 1, sizeof(sample_t));
+        pthread_create(&workers[i].thread, NULL, worker_run, workers + i);
+    }
+    for (long done = 0, shown = -1; done < games; sleep(1)) {
+        done = __sync_fetch_and_add(&finished, 0);
+        if (done != shown)
+            fprintf(stderr, "\r%ld/%ld games", shown = done, games);
+    }
+    fputc('\n', stderr);
+    for (int i = 0; i < threads; i++)
+        pthread_join(workers[i].thread, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    printf("seed,outcome,days,gold,food,wood,population,buildings\n");
+    long wins = 0, losses = 0;
+    double *win_days = calloc(games, sizeof(*win_days));
+    for (long n = 0; n < games; n++) {
+        result_t *r = results + n;
+        const char *outcome = "timeout";
+        if (r->outcome == EVENT_WIN) {
+            outcome = "win";
+            win_days[wins++] = r->time / DAY;
+        } else if (r->outcome == EVENT_LOSE) {
+            outcome = "loss";
+            losses++;
+        }
+        printf("%llu,%s,%.3f,%.1f,%.1f,%.1f,%.0f,%d\n",
+               (unsigned long long)r->seed, outcome, r->time / DAY,
+               r->gold, r->food, r->wood, r->population, r->buildings);
+    }
+
+    double sim_days = 0, step_cpu = 0, generate_cpu = 0;
+    for (int i = 0; i < threads; i++) {
+        sim_days += workers[i].days;
+        step_cpu += workers[i].step_cpu;
+        generate_cpu += workers[i].generate_cpu;
+    }
+    if (curves) {
+        FILE *f = fopen(curves, "w");
+        if (!f) {
+            perror(curves);
+            return EXIT_FAILURE;
+        }
+        fprintf(f, "day,games,gold,food,wood,population,buildings\n");
+        for (long d = 0; d <= days; d++) {
+            sample_t s = {0};
+            for (int i = 0; i < threads; i++) {
+                sample_t *t = workers[i].curve + d;
+                s.games += t->games;
+                s.gold += t->gold;
+                s.food += t->food;
+                s.wood += t->wood;
+                s.population += t->population;
+                s.buildings += t->buildings;
+            }
+            if (!s.games)
+                break;
+            fprintf(f, "%ld,%ld,%.1f,%.1f,%.1f,%.1f,%.2f\n", d, s.games,
+                    s.gold / s.games, s.food / s.games, s.wood / s.games,
+                    s.population / s.games, s.buildings / s.games);
+        }
+        fclose(f);
+    }
+
+    qsort(win_days, wins, sizeof(*win_days), days_cmp);
+    fprintf(stderr, "games     %ld on %d threads, order %s every %ld h\n",
+            games, threads, order, interval);
+    fprintf(stderr, "wins      %.1f%%\n", 100.0 * wins / games);
+    fprintf(stderr, "losses    %.1f%%\n", 100.0 * losses / games);
+    fprintf(stderr, "timeouts  %.1f%% (%ld days)\n",
+            100.0 * (games - wins - losses) / games, days);
+    if (wins)
+        fprintf(stderr, "win days  median %.2f, min %.2f, max %.2f\n",
+                win_days[wins / 2], win_days[0], win_days[wins - 1]);
+    fprintf(stderr, "sim       %.1f game-days/s/core (%.0f days, %.1f s)\n",
+            sim_days / step_cpu, sim_days, step_cpu);
+    fprintf(stderr, "worldgen  %.3f s/world\n", generate_cpu / games);
+    fprintf(stderr, "wall      %.1f s\n", wall);
+    return 0;
+}
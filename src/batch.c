@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "batch.h"
+#include "rand.h"
+
+/* Building slots are slot-major, [slot * lanes + lane], so that one
+ * slot of every lane is contiguous. A slot yields its building's
+ * per-second rates from game time ON onwards, and zeros before that or
+ * when empty, as adding zero leaves a resource exactly as it was.
+ */
+struct batch {
+    size_t lanes;
+    size_t slots, used; // allocated and highest in use
+    game_t *games;      // each with its own copy of the map
+    uint64_t *rand;
+    double *gold, *food, *wood;
+    long *wake;         // game time the next pending building turns on
+    unsigned *count;    // buildings in each lane
+    double *gold_rate, *food_rate, *wood_rate;
+    long *on;
+    uint16_t *type;
+    uint32_t *cell;     // chunk * CHUNK_CELLS + y * CHUNK_WIDTH + x
+};
+
+#define CHUNK_CELLS (CHUNK_WIDTH * CHUNK_HEIGHT)
+
+batch_t *
+batch_create(size_t lanes)
+{
+    batch_t *b = calloc(sizeof(*b), 1);
+    b->lanes = lanes;
+    b->games = calloc(lanes, sizeof(*b->games));
+    b->rand = calloc(lanes, sizeof(*b->rand));
+    b->gold = calloc(lanes, sizeof(*b->gold));
+    b->food = calloc(lanes, sizeof(*b->food));
+    b->wood = calloc(lanes, sizeof(*b->wood));
+    b->wake = calloc(lanes, sizeof(*b->wake));
+    b->count = calloc(lanes, sizeof(*b->count));
+    for (size_t i = 0; i < lanes; i++)
+        b->wake[i] = LONG_MAX;
+    return b;
+}
+
+void
+batch_free(batch_t *b)
+{
+    for (size_t i = 0; i < b->lanes; i++)
+        map_free(b->games[i].map);
+    free(b->games);
+    free(b->rand);
+    free(b->gold);
+    free(b->food);
+    free(b->wood);
+    free(b->wake);
+    free(b->count);
+    free(b->gold_rate);
+    free(b->food_rate);
+    free(b->wood_rate);
+    free(b->on);
+    free(b->type);
+    free(b->cell);
+    free(b);
+}
+
+static void
+slots_grow(batch_t *b, size_t slots)
+{
+    size_t old = b->slots * b->lanes;
+    size_t size = slots * b->lanes;
+    b->gold_rate = realloc(b->gold_rate, size * sizeof(*b->gold_rate));
+    b->food_rate = realloc(b->food_rate, size * sizeof(*b->food_rate));
+    b->wood_rate = realloc(b->wood_rate, size * sizeof(*b->wood_rate));
+    b->on = realloc(b->on, size * sizeof(*b->on));
+    b->type = realloc(b->type, size * sizeof(*b->type));
+    b->cell = realloc(b->cell, size * sizeof(*b->cell));
+    for (size_t k = old; k < size; k++) {
+        b->gold_rate[k] = b->food_rate[k] = b->wood_rate[k] = 0;
+        b->on[k] = LONG_MAX;
+        b->type[k] = C_NONE;
+        b->cell[k] = 0;
+    }
+    b->slots = slots;
+}
+
+/**
+ * Give lane I's slots the rates they yield at its current game time,
+ * and note when the next pending one turns on.
+ */
+static void
+lane_wake(batch_t *b, size_t i)
+{
+    long time = b->games[i].time;
+    b->wake[i] = LONG_MAX;
+    for (size_t j = 0; j < b->count[i]; j++) {
+        size_t k = j * b->lanes + i;
+        yield_t yield = {0, 0, 0};
+        if (b->on[k] <= time)
+            yield = building_yield(b->type[k]);
+        else if (b->on[k] < b->wake[i])
+            b->wake[i] = b->on[k];
+        b->gold_rate[k] = yield.gold / DAY;
+        b->food_rate[k] = yield.food / DAY;
+        b->wood_rate[k] = yield.wood / DAY;
+    }
+}
+
+/**
+ * Refill lane I from its game, with slots in the order game_step()
+ * visits buildings.
+ */
+static void
+lane_load(batch_t *b, size_t i)
+{
+    game_t *game = b->games + i;
+    b->gold[i] = game->gold;
+    b->food[i] = game->food;
+    b->wood[i] = game->wood;
+
+    map_t *map = game->map;
+    size_t n = 0;
+    for (int a = 0; a < map->active_count; a++)
+        n += map->chunk[map->active[a]]->buildings;
+    if (n > b->slots)
+        slots_grow(b, n > b->slots * 2 ? n : b->slots * 2);
+
+    size_t j = 0;
+    for (int a = 0; a < map->active_count; a++) {
+        map_chunk_t *chunk = map->chunk[map->active[a]];
+        const uint8_t *building = chunk->building[0];
+        const int32_t *age = chunk->age[0];
+        for (int c = 0; c < chunk->rows * CHUNK_WIDTH; c++) {
+            if (building[c] != C_NONE) {
+                size_t k = j++ * b->lanes + i;
+                b->type[k] = building[c];
+                b->cell[k] = map->active[a] * CHUNK_CELLS + c;
+                b->on[k] = game->time - age[c] - 1;
+            }
+        }
+    }
+    for (; j < b->count[i]; j++) {
+        size_t k = j * b->lanes + i;
+        b->gold_rate[k] = b->food_rate[k] = b->wood_rate[k] = 0;
+        b->on[k] = LONG_MAX;
+        b->type[k] = C_NONE;
+    }
+    b->count[i] = n;
+    if (n > b->used)
+        b->used = n;
+    lane_wake(b, i);
+}
+
+/**
+ * Write lane I's resources and building ages back into its game.
+ */
+static void
+lane_sync(batch_t *b, size_t i)
+{
+    game_t *game = b->games + i;
+    game->gold = b->gold[i];
+    game->food = b->food[i];
+    game->wood = b->wood[i];
+    for (size_t j = 0; j < b->count[i]; j++) {
+        size_t k = j * b->lanes + i;
+        int32_t *age = game->map->chunk[b->cell[k] / CHUNK_CELLS]->age[0];
+        long a = game->time - b->on[k] - 1;
+        age[b->cell[k] % CHUNK_CELLS] =
+            a < INT32_MIN ? INT32_MIN : a > INT32_MAX ? INT32_MAX : a;
+    }
+}
+
+/**
+ * Copy GAME, and its map, into LANE, to be played from random state
+ * RAND. Every lane must be loaded before stepping.
+ */
+void
+batch_load(batch_t *b, size_t lane, const game_t *game, uint64_t rand)
+{
+    map_free(b->games[lane].map);
+    b->games[lane] = *game;
+    b->games[lane].map = map_copy(game->map);
+    b->rand[lane] = rand;
+    lane_load(b, lane);
+}
+
+/**
+ * LANE's game, brought up to date. Units, heroes and events may be
+ * changed in place; after changing resources or buildings, call
+ * batch_reload() before the next step.
+ */
+game_t *
+batch_game(batch_t *b, size_t lane)
+{
+    lane_sync(b, lane);
+    return b->games + lane;
+}
+
+void
+batch_reload(batch_t *b, size_t lane)
+{
+    lane_load(b, lane);
+}
+
+/**
+ * game_build() in LANE.
+ */
+bool
+batch_build(batch_t *b, size_t lane, uint16_t building, int x, int y)
+{
+    bool built = game_build(batch_game(b, lane), building, x, y);
+    if (built)
+        lane_load(b, lane);
+    return built;
+}
+
+/**
+ * One building slot's yield across N lanes.
+ */
+static void
+slot_yield(size_t n, double *restrict gold, double *restrict food,
+           double *restrict wood, const double *restrict gold_rate,
+           const double *restrict food_rate, const double *restrict wood_rate)
+{
+    for (size_t i = 0; i < n; i++) {
+        wood[i] += wood_rate[i];
+        food[i] += food_rate[i];
+        gold[i] += gold_rate[i];
+    }
+}
+
+/**
+ * Advance every lane by one game_step().
+ */
+void
+batch_step(batch_t *b)
+{
+    size_t n = b->lanes;
+    for (size_t j = 0; j < b->used; j++)
+        slot_yield(n, b->gold, b->food, b->wood, b->gold_rate + j * n,
+                   b->food_rate + j * n, b->wood_rate + j * n);
+
+    uint64_t saved = rand_state;
+    for (size_t i = 0; i < n; i++) {
+        game_t *game = b->games + i;
+
+        /* Only an invader standing on a building can destroy it. */
+        int razing[countof(game->invaders)][2];
+        unsigned count = 0;
+        for (unsigned v = 0; v < countof(game->invaders); v++) {
+            invader_t *invader = game->invaders + v;
+            if (!invader->active)
+                continue;
+            int x = invader->x;
+            int y = invader->y;
+            if (map_building(game->map, x, y) != C_NONE) {
+                razing[count][0] = x;
+                razing[count++][1] = y;
+            }
+        }
+
+        rand_state = b->rand[i];
+        game_step_units(game);
+        b->rand[i] = rand_state;
+
+        bool razed = false;
+        for (unsigned v = 0; v < count; v++)
+            if (map_building(game->map, razing[v][0], razing[v][1]) == C_NONE)
+                razed = true;
+        if (razed) {
+            lane_sync(b, i);
+            lane_load(b, i);
+        } else if (game->time >= b->wake[i]) {
+            lane_wake(b, i);
+        }
+    }
+    rand_state = saved;
+}
@@ -0,0 +1,24 @@
+/**
+ * Lockstep batch of games for automated players. Each game is a lane:
+ * resources and buildings of all lanes are kept as structure-of-arrays
+ * and yield together, a building slot at a time across every lane,
+ * while units, heroes and events stay in each lane's own game_t and
+ * step game by game. batch_step() matches game_step() exactly.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+typedef struct batch batch_t;
+
+batch_t *batch_create(size_t lanes);
+void     batch_free(batch_t *);
+
+void     batch_load(batch_t *, size_t lane, const game_t *, uint64_t rand);
+game_t  *batch_game(batch_t *, size_t lane);
+void     batch_reload(batch_t *, size_t lane);
+bool     batch_build(batch_t *, size_t lane, uint16_t building, int x, int y);
+
+void     batch_step(batch_t *);
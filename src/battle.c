@@ -0,0 +1,141 @@
+#include "battle.h"
+
+/* The loops over lanes below scale by 0/1 flags where a branch would
+ * do, so that every lane stores and GCC can vectorize them. */
+
+/**
+ * Slots on side S that anyone in the first LANES battles still holds.
+ */
+static int
+side_rows(const battle_fighters_t *s, int lanes)
+{
+    for (int f = BATTLE_SIDE - 1; f >= 0; f--) {
+        int32_t any = 0;
+        for (int i = 0; i < lanes; i++)
+            any |= s->hp[f][i] > 0;
+        if (any)
+            return f + 1;
+    }
+    return 0;
+}
+
+/**
+ * Each lane's target on side S: the first fighter still standing, or
+ * -1, and that fighter's DEX.
+ */
+static void
+side_target(const battle_fighters_t *restrict s, int lanes, int rows,
+            int32_t *restrict target, int32_t *restrict dex)
+{
+    for (int i = 0; i < lanes; i++) {
+        target[i] = -1;
+        dex[i] = 0;
+    }
+    for (int f = rows - 1; f >= 0; f--) {
+        for (int i = 0; i < lanes; i++) {
+            int32_t standing = s->hp[f][i] > 0;
+            target[i] += standing * (f - target[i]);
+            dex[i] += standing * (s->dex[f][i] - dex[i]);
+        }
+    }
+}
+
+/**
+ * Side S attacks. Every fighter standing with the AP for it strikes
+ * the lane's target. Each blow takes its dice from one word of DICE, a
+ * row of LANES words per slot: a percentile ROLL from the low 16 bits
+ * and a 6-bit DIE from the top. It hits on a ROLL under 50 plus 4 for each
+ * point of DEX over the target's (5 to 95), for STR / 4 plus up to as
+ * much again from the DIE, doubled on a ROLL under MIND / 2. The blows
+ * add up into DAMAGE, and lanes where anyone struck are marked in
+ * ACTED.
+ */
+static void
+side_attack(battle_fighters_t *restrict s, int lanes, int rows,
+            const int32_t *restrict target, const int32_t *restrict dex,
+            const uint32_t *restrict dice, int32_t *restrict damage,
+            int32_t *restrict acted)
+{
+    for (int i = 0; i < lanes; i++)
+        damage[i] = 0;
+    for (int f = 0; f < rows; f++) {
+        const uint32_t *row = dice + f * lanes;
+        for (int i = 0; i < lanes; i++) {
+            int32_t roll = (row[i] & 0xffff) * 100 >> 16;
+            int32_t die = row[i] >> 26;
+            int32_t ready = (s->hp[f][i] > 0) &
+                            (s->ap[f][i] >= BATTLE_AP) &
+                            (target[i] >= 0);
+            int32_t chance = 50 + 4 * (s->dex[f][i] - dex[i]);
+            chance = chance < 5 ? 5 : chance > 95 ? 95 : chance;
+            int32_t hit = ready & (roll < chance);
+            int32_t crit = roll < s->mind[f][i] / 2;
+            int32_t base = s->str[f][i] / 4;
+            int32_t blow = (base + (die * (base + 1) >> 6)) * (1 + crit);
+            damage[i] += hit * blow;
+            s->ap[f][i] -= ready * BATTLE_AP;
+            acted[i] |= ready;
+        }
+    }
+}
+
+static void
+side_wound(battle_fighters_t *restrict s, int lanes, int rows,
+           const int32_t *restrict target, const int32_t *restrict damage)
+{
+    for (int f = 0; f < rows; f++)
+        for (int i = 0; i < lanes; i++)
+            s->hp[f][i] -= (f == target[i]) * damage[i];
+}
+
+/**
+ * Fight the first LANES battles of B to the end, drawing dice from RNG.
+ * Both sides strike at once each round, until one side has fallen, no
+ * one has the AP left to attack, or BATTLE_ROUNDS have passed.
+ */
+void
+battle_resolve(battle_t *b, int lanes, xoshiro_t *rng)
+{
+    int32_t target[2][BATTLE_LANES];
+    int32_t dex[2][BATTLE_LANES];
+    int32_t damage[2][BATTLE_LANES];
+    int32_t acted[BATTLE_LANES];
+    uint32_t dice[BATTLE_SIDE * BATTLE_LANES];
+    for (int i = 0; i < lanes; i++)
+        b->rounds[i] = 0;
+    for (int r = 0; r < BATTLE_ROUNDS; r++) {
+        int rows[2];
+        for (int s = 0; s < 2; s++)
+            rows[s] = side_rows(&b->side[s], lanes);
+        for (int s = 0; s < 2; s++)
+            side_target(&b->side[!s], lanes, rows[!s], target[s], dex[s]);
+        for (int i = 0; i < lanes; i++)
+            acted[i] = 0;
+        for (int s = 0; s < 2; s++) {
+            xoshiro_fill(rng, dice, rows[s] * lanes);
+            side_attack(&b->side[s], lanes, rows[s], target[s], dex[s],
+                        dice, damage[s], acted);
+        }
+        for (int s = 0; s < 2; s++)
+            side_wound(&b->side[!s], lanes, rows[!s], target[s], damage[s]);
+        int32_t any = 0;
+        for (int i = 0; i < lanes; i++) {
+            b->rounds[i] += acted[i];
+            any |= acted[i];
+        }
+        if (!any)
+            break;
+    }
+}
+
+/**
+ * Fighters on SIDE still standing in LANE.
+ */
+int
+battle_standing(const battle_t *b, enum battle_side side, int lane)
+{
+    int count = 0;
+    for (int f = 0; f < BATTLE_SIDE; f++)
+        count += b->side[side].hp[f][lane] > 0;
+    return count;
+}
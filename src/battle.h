@@ -0,0 +1,35 @@
+/**
+ * Auto-resolved battles between a squad of heroes and a band of
+ * goblins. Each battle is a lane, and a batch of lanes fights in
+ * lockstep: every stat of every fighter slot is an array across lanes,
+ * so each step of a round is a loop over lanes that the compiler can
+ * vectorize. The game resolves its battles as a batch of one.
+ */
+#pragma once
+
+#include <stdint.h>
+#include "rand.h"
+
+#define BATTLE_SIDE   8  // fighter slots a side
+#define BATTLE_LANES  64 // battles a batch at most
+#define BATTLE_ROUNDS 16 // rounds before both sides break off
+#define BATTLE_AP     5  // AP an attack costs
+
+enum battle_side { BATTLE_HEROES, BATTLE_GOBLINS };
+
+/* Empty slots, and fighters that have fallen, have no HP. */
+typedef struct {
+    int32_t hp[BATTLE_SIDE][BATTLE_LANES];
+    int32_t ap[BATTLE_SIDE][BATTLE_LANES];
+    int32_t str[BATTLE_SIDE][BATTLE_LANES];
+    int32_t dex[BATTLE_SIDE][BATTLE_LANES];
+    int32_t mind[BATTLE_SIDE][BATTLE_LANES];
+} battle_fighters_t;
+
+typedef struct {
+    battle_fighters_t side[2];
+    int32_t rounds[BATTLE_LANES]; // rounds in which anyone attacked
+} battle_t;
+
+void battle_resolve(battle_t *, int lanes, xoshiro_t *);
+int  battle_standing(const battle_t *, enum battle_side, int lane);
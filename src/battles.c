@@ -0,0 +1,138 @@
+/**
+ * Battle runner. Resolves many battles between squads of fresh heroes
+ * and a band of goblins, BATTLE_LANES at a time, and writes one CSV row
+ * per squad size to standard output, with how the battles went, and
+ * the resolver's speed to standard error.
+ *
+ *   battles [-n BATTLES] [-s SEED]
+ *
+ * BATTLES are fought at each squad size, 1 to BATTLE_SIDE heroes. A
+ * battle is won when every goblin falls, lost when every hero falls
+ * and the goblins do not, and undecided otherwise. Speed is battles
+ * per millisecond of CPU time spent in battle_resolve().
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include "game.h"
+#include "battle.h"
+#include "rand.h"
+
+typedef struct {
+    long battles, won, lost;
+    long rounds, falls, hp_lost;
+} tally_t;
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+muster(battle_t *b, int heroes, int lanes)
+{
+    battle_fighters_t *h = b->side + BATTLE_HEROES;
+    battle_fighters_t *g = b->side + BATTLE_GOBLINS;
+    for (int f = 0; f < BATTLE_SIDE; f++) {
+        for (int i = 0; i < lanes; i++) {
+            hero_t hero = {0};
+            if (f < heroes)
+                hero = game_hero_generate();
+            h->hp[f][i] = hero.hp;
+            h->ap[f][i] = hero.ap;
+            h->str[f][i] = hero.str;
+            h->dex[f][i] = hero.dex;
+            h->mind[f][i] = hero.mind;
+            bool goblin = f < GOBLIN_BAND;
+            g->hp[f][i] = goblin ? GOBLIN_HP : 0;
+            g->ap[f][i] = goblin ? GOBLIN_AP : 0;
+            g->str[f][i] = GOBLIN_STR;
+            g->dex[f][i] = GOBLIN_DEX;
+            g->mind[f][i] = GOBLIN_MIND;
+        }
+    }
+}
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-n BATTLES] [-s SEED]\n", name);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    long count = 100000;
+    uint64_t seed = 1;
+    for (int option; (option = getopt(argc, argv, "n:s:")) != -1;) {
+        switch (option) {
+        case 'n':
+            count = atol(optarg);
+            break;
+        case 's':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+        }
+    }
+    if (optind != argc || count < 1)
+        usage(argv[0]);
+
+    rand_state = seed;
+    xoshiro_t rng;
+    xoshiro_seed(&rng, xorshift(&rand_state));
+    battle_t *b = malloc(sizeof(*b));
+    battle_t *start = malloc(sizeof(*start));
+    tally_t tally[BATTLE_SIDE + 1] = {{0}};
+    double cpu = 0;
+    long battles = 0;
+    for (int heroes = 1; heroes <= BATTLE_SIDE; heroes++) {
+        tally_t *t = tally + heroes;
+        for (long n = 0; n < count; n += BATTLE_LANES) {
+            int lanes = count - n < BATTLE_LANES ? count - n : BATTLE_LANES;
+            muster(start, heroes, lanes);
+            *b = *start;
+            double t0 = now();
+            battle_resolve(b, lanes, &rng);
+            cpu += now() - t0;
+            battles += lanes;
+            for (int i = 0; i < lanes; i++) {
+                int standing = battle_standing(b, BATTLE_HEROES, i);
+                int goblins = battle_standing(b, BATTLE_GOBLINS, i);
+                t->battles++;
+                t->won += !goblins;
+                t->lost += !standing && goblins;
+                t->rounds += b->rounds[i];
+                t->falls += heroes - standing;
+                for (int f = 0; f < heroes; f++) {
+                    int hp = b->side[BATTLE_HEROES].hp[f][i];
+                    t->hp_lost += start->side[BATTLE_HEROES].hp[f][i] -
+                                  (hp > 0 ? hp : 0);
+                }
+            }
+        }
+    }
+
+    printf("heroes,battles,won,lost,undecided,rounds,falls,hp_lost\n");
+    for (int heroes = 1; heroes <= BATTLE_SIDE; heroes++) {
+        tally_t *t = tally + heroes;
+        double n = t->battles;
+        printf("%d,%ld,%.3f,%.3f,%.3f,%.2f,%.3f,%.2f\n", heroes, t->battles,
+               t->won / n, t->lost / n, (t->battles - t->won - t->lost) / n,
+               t->rounds / n, t->falls / n, t->hp_lost / n);
+    }
+    fprintf(stderr, "battles   %ld in batches of %d\n",
+            battles, BATTLE_LANES);
+    fprintf(stderr, "speed     %.0f battles/ms\n", battles / cpu / 1e3);
+    free(start);
+    free(b);
+    return 0;
+}
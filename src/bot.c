@@ -0,0 +1,436 @@
+/**
+ * Commands, one JSON object per line:
+ *
+ *   {"cmd":"state"}                     everything, not just changes
+ *   {"cmd":"map"}                       terrain, as "map":[row, ...]
+ *   {"cmd":"build","building":"F","x":31,"y":12}
+ *   {"cmd":"target","squad":0,"invader":3}   -1 recalls the squad
+ *   {"cmd":"candidates"}                heroes for hire, as "candidates"
+ *   {"cmd":"hire","slot":2,"candidate":1}
+ *   {"cmd":"assign","hero":2,"squad":1}      -1 leaves all squads
+ *   {"cmd":"step","seconds":3600}       stops early when the game ends
+ *   {"cmd":"quit"}
+ *
+ * Every answer has "ok", "error" if not ok, "time", "gold", "food",
+ * "wood", "population" and "max_hero". Buildings ([x, y, "F"], with ""
+ * once razed), invaders, squads and heroes are listed only when they
+ * changed, and "events" counts the events since the last answer. Once
+ * the game is won or lost, "over" says which.
+ *
+ * Terrain letters: ~ ocean, - coast, . grassland, f forest, h hill,
+ * ^ mountain, : sand.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bot.h"
+#include "game.h"
+#include "rand.h"
+
+#define COMMAND_MAX 4096
+#define TOLD_MAX    160 // JSON of one list entry
+
+enum extra { EXTRA_NONE, EXTRA_MAP, EXTRA_CANDIDATES };
+
+typedef struct {
+    game_t *game;
+    FILE *out;
+    enum game_event over;
+    enum extra extra;
+    unsigned events[EVENT_BATTLE + 1];
+    unsigned candidate_count;
+    hero_t candidates[HERO_CANDIDATES];
+    /* What the bot was last told. */
+    uint16_t buildings[MAP_WIDTH][MAP_HEIGHT];
+    char invaders[countof(((game_t *)0)->invaders)][TOLD_MAX];
+    char squads[countof(((game_t *)0)->squads)][TOLD_MAX];
+    char heroes[countof(((game_t *)0)->heroes)][TOLD_MAX];
+} bot_t;
+
+static const char *const event_names[] = {
+    [EVENT_LOSE] = "lose",
+    [EVENT_WIN] = "win",
+    [EVENT_PROGRESS_1] = "progress",
+    [EVENT_BATTLE] = "battle",
+};
+
+/**
+ * The value of KEY in a flat JSON object, or NULL.
+ */
+static const char *
+field(const char *line, const char *key)
+{
+    size_t len = strlen(key);
+    for (const char *p = line; (p = strchr(p, '"')); p++) {
+        if (strncmp(p + 1, key, len) == 0 && p[len + 1] == '"') {
+            const char *v = p + len + 2;
+            v += strspn(v, " \t");
+            if (*v == ':')
+                return v + 1 + strspn(v + 1, " \t");
+        }
+    }
+    return NULL;
+}
+
+static bool
+field_int(const char *line, const char *key, int *value)
+{
+    const char *p = field(line, key);
+    char *end;
+    if (!p)
+        return false;
+    *value = strtol(p, &end, 10);
+    return end != p;
+}
+
+static bool
+field_string(const char *line, const char *key, char *buf, size_t size)
+{
+    const char *p = field(line, key);
+    if (!p || *p++ != '"')
+        return false;
+    size_t len = strcspn(p, "\"");
+    if (p[len] != '"' || len >= size)
+        return false;
+    memcpy(buf, p, len);
+    buf[len] = '\0';
+    return true;
+}
+
+static char
+terrain_letter(uint16_t base)
+{
+    switch (base) {
+    case BASE_OCEAN:
+        return '~';
+    case BASE_COAST:
+        return '-';
+    case BASE_GRASSLAND:
+        return '.';
+    case BASE_FOREST:
+        return 'f';
+    case BASE_HILL:
+        return 'h';
+    case BASE_MOUNTAIN:
+        return '^';
+    case BASE_SAND:
+        return ':';
+    }
+    return '?';
+}
+
+static const char *
+do_build(bot_t *bot, const char *line)
+{
+    char building[2];
+    int x, y;
+    if (!field_string(line, "building", building, sizeof(building)) ||
+        !field_int(line, "x", &x) || !field_int(line, "y", &y))
+        return "build needs building, x and y";
+    if (!building[0] || !strchr("WFHMS+", building[0]))
+        return "unknown building";
+    if (!game_can_afford(bot->game, building_cost(building[0])))
+        return "not enough funding/materials";
+    if (x < 0 || x >= MAP_WIDTH || y < 0 || y >= MAP_HEIGHT ||
+        !game_build(bot->game, building[0], x, y))
+        return "invalid building location";
+    return NULL;
+}
+
+static const char *
+do_target(bot_t *bot, const char *line)
+{
+    game_t *game = bot->game;
+    int squad, invader;
+    if (!field_int(line, "squad", &squad) ||
+        !field_int(line, "invader", &invader))
+        return "target needs squad and invader";
+    if (squad < 0 || squad >= (int)countof(game->squads))
+        return "no such squad";
+    if (invader < -1 || invader >= (int)countof(game->invaders) ||
+        (invader >= 0 && !game->invaders[invader].active))
+        return "no such invader";
+    game->squads[squad].target = invader;
+    return NULL;
+}
+
+static const char *
+do_hire(bot_t *bot, const char *line)
+{
+    game_t *game = bot->game;
+    int slot, candidate;
+    if (!field_int(line, "slot", &slot) ||
+        !field_int(line, "candidate", &candidate))
+        return "hire needs slot and candidate";
+    if (candidate < 0 || candidate >= (int)bot->candidate_count)
+        return "no such candidate";
+    if (slot < 0 || slot >= game->max_hero || game->heroes[slot].active)
+        return "slot not available";
+    game->heroes[slot] = bot->candidates[candidate];
+    bot->candidate_count = 0;
+    return NULL;
+}
+
+static const char *
+do_assign(bot_t *bot, const char *line)
+{
+    game_t *game = bot->game;
+    int index, squad;
+    if (!field_int(line, "hero", &index) || !field_int(line, "squad", &squad))
+        return "assign needs hero and squad";
+    if (index < 0 || index >= (int)countof(game->heroes) ||
+        !game->heroes[index].active)
+        return "no such hero";
+    if (squad < -1 || squad >= (int)countof(game->squads))
+        return "no such squad";
+    hero_t *hero = game->heroes + index;
+    if (hero->squad >= 0)
+        game->squads[hero->squad].member_count--;
+    hero->squad = squad;
+    if (hero->squad >= 0)
+        game->squads[hero->squad].member_count++;
+    return NULL;
+}
+
+static void
+collect_events(bot_t *bot)
+{
+    enum game_event event;
+    while ((event = game_event_pop(bot->game)) != EVENT_NONE) {
+        bot->events[event]++;
+        if ((event == EVENT_WIN || event == EVENT_LOSE) && !bot->over)
+            bot->over = event;
+    }
+}
+
+static const char *
+do_step(bot_t *bot, const char *line)
+{
+    int seconds = 1;
+    if (field(line, "seconds") && !field_int(line, "seconds", &seconds))
+        return "seconds must be a number";
+    if (bot->over)
+        return "game over";
+    for (int i = 0; i < seconds && !bot->over; i++) {
+        game_step(bot->game);
+        collect_events(bot);
+    }
+    return NULL;
+}
+
+/**
+ * Run one command line. Returns an error message, or NULL.
+ */
+static const char *
+command(bot_t *bot, const char *line, bool *quit)
+{
+    char cmd[16];
+    bot->extra = EXTRA_NONE;
+    if (!field_string(line, "cmd", cmd, sizeof(cmd)))
+        return "no cmd given";
+    if (strcmp(cmd, "state") == 0) {
+        memset(bot->buildings, 0, sizeof(bot->buildings));
+        memset(bot->invaders, 0, sizeof(bot->invaders));
+        memset(bot->squads, 0, sizeof(bot->squads));
+        memset(bot->heroes, 0, sizeof(bot->heroes));
+    } else if (strcmp(cmd, "map") == 0) {
+        bot->extra = EXTRA_MAP;
+    } else if (strcmp(cmd, "build") == 0) {
+        return do_build(bot, line);
+    } else if (strcmp(cmd, "target") == 0) {
+        return do_target(bot, line);
+    } else if (strcmp(cmd, "candidates") == 0) {
+        for (unsigned i = 0; i < countof(bot->candidates); i++)
+            bot->candidates[i] = game_hero_generate();
+        bot->candidate_count = countof(bot->candidates);
+        bot->extra = EXTRA_CANDIDATES;
+    } else if (strcmp(cmd, "hire") == 0) {
+        return do_hire(bot, line);
+    } else if (strcmp(cmd, "assign") == 0) {
+        return do_assign(bot, line);
+    } else if (strcmp(cmd, "step") == 0) {
+        return do_step(bot, line);
+    } else if (strcmp(cmd, "quit") == 0) {
+        *quit = true;
+    } else {
+        return "unknown command";
+    }
+    return NULL;
+}
+
+static void
+hero_json(char *buf, size_t size, int id, const hero_t *h)
+{
+    snprintf(buf, size, "{\"id\":%d,\"name\":\"%s\",\"squad\":%d,"
+             "\"hp\":%d,\"hp_max\":%d,\"ap\":%d,\"ap_max\":%d,"
+             "\"str\":%d,\"dex\":%d,\"mind\":%d}",
+             id, h->name, h->squad, h->hp, h->hp_max, h->ap, h->ap_max,
+             h->str, h->dex, h->mind);
+}
+
+/**
+ * Print an entry of a list if its JSON differs from what the bot was
+ * last told, and remember it. An entry that is gone is told once.
+ */
+static void
+list_change(FILE *out, const char *name, char *told, size_t size,
+            const char *now, bool *first)
+{
+    if (strcmp(told, now) == 0)
+        return;
+    if (*first)
+        fprintf(out, ",\"%s\":[", name);
+    else
+        fputc(',', out);
+    fputs(now, out);
+    *first = false;
+    snprintf(told, size, "%s", now);
+}
+
+static void
+list_gone(FILE *out, const char *name, char *told, unsigned id, bool *first)
+{
+    if (!told[0])
+        return;
+    if (*first)
+        fprintf(out, ",\"%s\":[", name);
+    else
+        fputc(',', out);
+    fprintf(out, "{\"id\":%u,\"active\":false}", id);
+    *first = false;
+    told[0] = '\0';
+}
+
+static void
+answer(bot_t *bot, const char *error)
+{
+    game_t *game = bot->game;
+    FILE *out = bot->out;
+    fprintf(out, "{\"ok\":%s", error ? "false" : "true");
+    if (error)
+        fprintf(out, ",\"error\":\"%s\"", error);
+    fprintf(out, ",\"time\":%ld,\"gold\":%.3f,\"food\":%.3f,\"wood\":%.3f,"
+            "\"population\":%.0f,\"max_hero\":%d",
+            game->time, game->gold, game->food, game->wood,
+            game->population, game->max_hero);
+
+    if (bot->extra == EXTRA_MAP) {
+        fputs(",\"map\":[", out);
+        for (int y = 0; y < MAP_HEIGHT; y++) {
+            fputs(y ? ",\"" : "\"", out);
+            for (int x = 0; x < MAP_WIDTH; x++)
+                fputc(terrain_letter(map_base(game->map, x, y)), out);
+            fputc('"', out);
+        }
+        fputc(']', out);
+    } else if (bot->extra == EXTRA_CANDIDATES) {
+        fputs(",\"candidates\":[", out);
+        for (unsigned i = 0; i < bot->candidate_count; i++) {
+            char buf[TOLD_MAX];
+            hero_json(buf, sizeof(buf), i, bot->candidates + i);
+            fprintf(out, "%s%s", i ? "," : "", buf);
+        }
+        fputc(']', out);
+    }
+
+    bool first = true;
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        for (int x = 0; x < MAP_WIDTH; x++) {
+            uint16_t building = map_building(game->map, x, y);
+            if (building != bot->buildings[x][y]) {
+                char letter[2] = {(char)building, 0};
+                fprintf(out, "%s[%d,%d,\"%s\"]",
+                        first ? ",\"buildings\":[" : ",", x, y, letter);
+                first = false;
+                bot->buildings[x][y] = building;
+            }
+        }
+    }
+    if (!first)
+        fputc(']', out);
+
+    char now[TOLD_MAX];
+    first = true;
+    for (unsigned i = 0; i < countof(game->invaders); i++) {
+        invader_t *v = game->invaders + i;
+        if (!v->active) {
+            list_gone(out, "invaders", bot->invaders[i], i, &first);
+            continue;
+        }
+        snprintf(now, sizeof(now), "{\"id\":%u,\"x\":%.3f,\"y\":%.3f}",
+                 i, v->x, v->y);
+        list_change(out, "invaders", bot->invaders[i],
+                    sizeof(bot->invaders[i]), now, &first);
+    }
+    if (!first)
+        fputc(']', out);
+
+    first = true;
+    for (unsigned i = 0; i < countof(game->squads); i++) {
+        squad_t *s = game->squads + i;
+        snprintf(now, sizeof(now),
+                 "{\"id\":%u,\"x\":%.3f,\"y\":%.3f,\"target\":%d,"
+                 "\"members\":%u}", i, s->x, s->y, s->target, s->member_count);
+        list_change(out, "squads", bot->squads[i], sizeof(bot->squads[i]),
+                    now, &first);
+    }
+    if (!first)
+        fputc(']', out);
+
+    first = true;
+    for (unsigned i = 0; i < countof(game->heroes); i++) {
+        hero_t *h = game->heroes + i;
+        if (!h->active) {
+            list_gone(out, "heroes", bot->heroes[i], i, &first);
+            continue;
+        }
+        hero_json(now, sizeof(now), i, h);
+        list_change(out, "heroes", bot->heroes[i], sizeof(bot->heroes[i]),
+                    now, &first);
+    }
+    if (!first)
+        fputc(']', out);
+
+    first = true;
+    for (unsigned i = 0; i < countof(bot->events); i++) {
+        if (bot->events[i]) {
+            fprintf(out, "%s\"%s\":%u", first ? ",\"events\":{" : ",",
+                    event_names[i], bot->events[i]);
+            first = false;
+            bot->events[i] = 0;
+        }
+    }
+    if (!first)
+        fputc('}', out);
+
+    if (bot->over)
+        fprintf(out, ",\"over\":\"%s\"", event_names[bot->over]);
+    fputs("}\n", out);
+}
+
+/**
+ * Play a game of map SEED driven by commands from IN, answering on
+ * OUT, until "quit" or the end of input.
+ */
+int
+bot_run(FILE *in, FILE *out, uint64_t seed)
+{
+    bot_t *bot = calloc(sizeof(*bot), 1);
+    bot->game = game_create(seed, MAP_DIAMOND_SQUARE, MAP_WIDTH, MAP_HEIGHT);
+    bot->out = out;
+    char line[COMMAND_MAX];
+    bool quit = false;
+    answer(bot, NULL); // the starting state
+    fflush(out);
+    while (!quit && fgets(line, sizeof(line), in)) {
+        if (line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+        const char *error = command(bot, line, &quit);
+        collect_events(bot);
+        answer(bot, error);
+        fflush(out);
+    }
+    game_free(bot->game);
+    free(bot);
+    return 0;
+}
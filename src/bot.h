@@ -0,0 +1,13 @@
+/**
+ * Line protocol for bots and automated tests. Each line read is one
+ * flat JSON object naming a command, and each is answered with one
+ * line: the outcome, the resources, and whatever else changed since
+ * the previous answer. Nothing is drawn. The commands are listed in
+ * bot.c.
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+int bot_run(FILE *in, FILE *out, uint64_t seed);
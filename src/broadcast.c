@@ -0,0 +1,239 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "broadcast.h"
+#include "server.h"
+#include "device_unix.h"
+#include "display.h"
+
+#define VIEWERS_MAX 1024
+#define QUEUE_MAX 32 // frames a viewer may lag before it is resynced
+#define SNDBUF (32 * 1024) // keep lag visible here, not in the kernel
+
+/* Telnet: the server echoes and suppresses go-ahead, so the viewer's
+ * terminal stays quiet and unbuffered. */
+static const uint8_t hello[] = {255, 251, 1, 255, 251, 3};
+
+/* A frame shared by every viewer it was queued on. */
+typedef struct frame {
+    int refs;
+    size_t len;
+    char data[];
+} frame_t;
+
+typedef struct viewer {
+    int fd;
+    int head, count;
+    size_t offset; // bytes of the head frame already sent
+    frame_t *queue[QUEUE_MAX];
+} viewer_t;
+
+static struct {
+    int listener;
+    viewer_t *viewers[VIEWERS_MAX];
+    int count;
+    frame_t *keyframe; // the current screen, built at most once per frame
+} broadcast;
+
+static frame_t *
+frame_create(const char *data, size_t len)
+{
+    frame_t *f = malloc(sizeof(*f) + len);
+    f->refs = 1;
+    f->len = len;
+    memcpy(f->data, data, len);
+    return f;
+}
+
+static void
+frame_release(frame_t *f)
+{
+    if (f && --f->refs == 0)
+        free(f);
+}
+
+/**
+ * Encode the whole screen through a scratch terminal.
+ */
+static frame_t *
+keyframe(void)
+{
+    if (!broadcast.keyframe) {
+        terminal_t scratch;
+        terminal_init(&scratch, -1, -1);
+        terminal_t *previous = device_select(&scratch);
+        device_init(); // clears the screen and hides the cursor
+        display_repaint();
+        device_select(previous);
+        broadcast.keyframe = frame_create(scratch.output, scratch.output_len);
+        terminal_free(&scratch);
+    }
+    return broadcast.keyframe;
+}
+
+static void
+viewer_push(viewer_t *v, frame_t *f)
+{
+    f->refs++;
+    v->queue[(v->head + v->count++) % QUEUE_MAX] = f;
+}
+
+/**
+ * Drop everything queued for V and queue a keyframe in its place. A
+ * partly sent frame is finished first so no sequence is cut short.
+ */
+static void
+viewer_resync(viewer_t *v)
+{
+    int keep = v->offset ? 1 : 0;
+    for (int i = keep; i < v->count; i++)
+        frame_release(v->queue[(v->head + i) % QUEUE_MAX]);
+    v->count = keep;
+    viewer_push(v, keyframe());
+}
+
+static void
+viewer_close(viewer_t *v)
+{
+    device_watch(v->fd, 0, NULL, NULL);
+    close(v->fd);
+    for (int i = 0; i < v->count; i++)
+        frame_release(v->queue[(v->head + i) % QUEUE_MAX]);
+    for (int i = 0; i < broadcast.count; i++) {
+        if (broadcast.viewers[i] == v) {
+            broadcast.viewers[i] = broadcast.viewers[--broadcast.count];
+            break;
+        }
+    }
+    free(v);
+}
+
+static void viewer_event(void *, int, short);
+
+/**
+ * Write as much of the queue as the socket accepts. Returns false if
+ * the viewer went away.
+ */
+static bool
+viewer_send(viewer_t *v)
+{
+    while (v->count) {
+        struct iovec iov[QUEUE_MAX];
+        for (int i = 0; i < v->count; i++) {
+            frame_t *f = v->queue[(v->head + i) % QUEUE_MAX];
+            iov[i].iov_base = f->data;
+            iov[i].iov_len = f->len;
+        }
+        iov[0].iov_base = (char *)iov[0].iov_base + v->offset;
+        iov[0].iov_len -= v->offset;
+        ssize_t r = writev(v->fd, iov, v->count);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (r <= 0)
+            return false;
+        size_t done = r + v->offset;
+        while (v->count && done >= v->queue[v->head]->len) {
+            done -= v->queue[v->head]->len;
+            frame_release(v->queue[v->head]);
+            v->head = (v->head + 1) % QUEUE_MAX;
+            v->count--;
+        }
+        v->offset = done;
+    }
+    device_watch(v->fd, POLLIN | (v->count ? POLLOUT : 0), viewer_event, v);
+    return true;
+}
+
+static void
+viewer_event(void *arg, int fd, short revents)
+{
+    viewer_t *v = arg;
+    if (revents & POLLIN) {
+        char discard[256]; // viewers cannot play
+        ssize_t r = read(fd, discard, sizeof(discard));
+        if (r == 0 || (r < 0 && errno != EAGAIN && errno != EINTR)) {
+            viewer_close(v);
+            return;
+        }
+    }
+    if ((revents & (POLLERR | POLLHUP)) || !viewer_send(v))
+        viewer_close(v);
+}
+
+static void
+broadcast_accept(void *arg, int listener, short revents)
+{
+    (void)arg;
+    (void)revents;
+    int fd;
+    while ((fd = accept4(listener, NULL, NULL,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        if (broadcast.count == VIEWERS_MAX) {
+            close(fd);
+            continue;
+        }
+        int yes = 1;
+        int sndbuf = SNDBUF;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        viewer_t *v = calloc(sizeof(*v), 1);
+        v->fd = fd;
+        broadcast.viewers[broadcast.count++] = v;
+        frame_t *f = frame_create((const char *)hello, sizeof(hello));
+        viewer_push(v, f);
+        frame_release(f);
+        viewer_push(v, keyframe());
+        if (!viewer_send(v))
+            viewer_close(v);
+    }
+}
+
+/**
+ * Receives each frame from the local terminal. The frame is copied
+ * once and queued by reference on every viewer.
+ */
+static void
+broadcast_tee(void *arg, const char *data, size_t len)
+{
+    (void)arg;
+    frame_release(broadcast.keyframe);
+    broadcast.keyframe = NULL;
+    if (!broadcast.count)
+        return;
+    frame_t *f = frame_create(data, len);
+    for (int i = broadcast.count - 1; i >= 0; i--) {
+        viewer_t *v = broadcast.viewers[i];
+        if (v->count == QUEUE_MAX)
+            viewer_resync(v);
+        else
+            viewer_push(v, f);
+        if (!viewer_send(v))
+            viewer_close(v);
+    }
+    frame_release(f);
+}
+
+int
+broadcast_start(int port)
+{
+    broadcast.listener = server_listen(port);
+    if (broadcast.listener < 0)
+        return -1;
+    signal(SIGPIPE, SIG_IGN);
+    device_watch(broadcast.listener, POLLIN, broadcast_accept, NULL);
+    terminal_t *local = device_current();
+    local->tee = broadcast_tee;
+    local->tee_arg = NULL;
+    return 0;
+}
@@ -0,0 +1,8 @@
+/**
+ * Spectator broadcast. Every frame the local game sends to its own
+ * terminal is also fanned out, encoded once, to any number of
+ * read-only telnet viewers.
+ */
+#pragma once
+
+int broadcast_start(int port);
@@ -17,6 +17,42 @@
 #define ARROW_UR 309
 #define ARROW_DR 310
 
+static inline bool
+arrow_delta(int key, int *dx, int *dy)
+{
+    switch (key) {
+    case ARROW_U:
+        (*dy)--;
+        return true;
+    case ARROW_D:
+        (*dy)++;
+        return true;
+    case ARROW_L:
+        (*dx)--;
+        return true;
+    case ARROW_R:
+        (*dx)++;
+        return true;
+    case ARROW_UL:
+        (*dx)--;
+        (*dy)--;
+        return true;
+    case ARROW_UR:
+        (*dx)++;
+        (*dy)--;
+        return true;
+    case ARROW_DL:
+        (*dx)--;
+        (*dy)++;
+        return true;
+    case ARROW_DR:
+        (*dx)++;
+        (*dy)++;
+        return true;
+    }
+    return false;
+}
+
 #define COLOR_BLACK   0
 #define COLOR_RED     1
 #define COLOR_GREEN   2
@@ -37,7 +73,7 @@ static inline bool
 font_equal(font_t a, font_t b)
 {
     return a.fore == b.fore && a.back == b.back &&
-        a.fore_bright == b.fore_bright && a.back_bright && b.back_bright;
+        a.fore_bright == b.fore_bright && a.back_bright == b.back_bright;
 }
 
 void     device_init(void);
@@ -46,13 +82,22 @@ void     device_move(int x, int y);
 void     device_cursor_get(int *x, int *y);
 void     device_putc(font_t font, uint16_t c);
 void     device_flush(void);
+bool     device_writable(void);
 int      device_getch(void);
+bool     device_motion(int *dx, int *dy);
 bool     device_kbhit(uint64_t);
+bool     device_tick(uint64_t period);
+int      device_frames(void);
+bool     device_resized(void);
 uint64_t device_uepoch(void);
 void     device_title(const char *);
 void     device_terminal_size(int *, int *);
 void     device_entropy(void *, size_t);
 
+struct journal;
+void     device_journal(struct journal *);
+bool     device_headless(void);
+
 /* Shorthand Font Literals */
 
 #define COLOR__FONT_R (0x10 | COLOR_RED)
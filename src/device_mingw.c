@@ -4,11 +4,14 @@
 #include "display.h"
 #include "rand.h"
 #include "device.h"
+#include "journal.h"
 
 static CHAR_INFO buffer[DISPLAY_HEIGHT][DISPLAY_WIDTH];
 static HANDLE console_out;
 static HANDLE console_in;
 static int cursor_x, cursor_y;
+static int pushback = -1;
+static journal_t *journal;
 
 void
 device_init(void)
@@ -24,6 +27,8 @@ device_free(void)
 {
     CONSOLE_CURSOR_INFO info = {100, true};
     SetConsoleCursorInfo(console_out, &info);
+    journal_close(journal);
+    journal = NULL;
 }
 
 void
@@ -128,9 +133,20 @@ device_flush(void)
     WriteConsoleOutputW(console_out, buffer[0], size, origin, &area);
 }
 
-int
-device_getch(void)
+bool
+device_writable(void)
+{
+    return journal_int(journal, JOURNAL_WRITABLE, true);
+}
+
+static int
+console_getch(void)
 {
+    if (pushback >= 0) {
+        int key = pushback;
+        pushback = -1;
+        return key;
+    }
     int result = getch();
     if (result != 0xE0 && result != 0x00) {
         return result;
@@ -159,10 +175,39 @@ device_getch(void)
     }
 }
 
-/* http://stackoverflow.com/a/21749034 */
+int
+device_getch(void)
+{
+    if (journal_replaying(journal))
+        return journal_int(journal, JOURNAL_GETCH, 0);
+    return journal_int(journal, JOURNAL_GETCH, console_getch());
+}
+
 bool
-device_kbhit(uint64_t useconds)
+device_motion(int *dx, int *dy)
 {
+    int mx = 0, my = 0;
+    bool any = false;
+    while (!journal_replaying(journal) && pushback < 0 && _kbhit()) {
+        int key = console_getch();
+        if (arrow_delta(key, &mx, &my))
+            any = true;
+        else
+            pushback = key;
+    }
+    if (!journal_int(journal, JOURNAL_MOTION, any))
+        return false;
+    *dx += journal_int(journal, JOURNAL_MOTION_X, mx);
+    *dy += journal_int(journal, JOURNAL_MOTION_Y, my);
+    return true;
+}
+
+/* http://stackoverflow.com/a/21749034 */
+static bool
+console_kbhit(uint64_t useconds)
+{
+    if (pushback >= 0)
+        return true;
     DWORD mseconds = useconds / 1000ULL;
     for (;;) {
         DWORD result = WaitForSingleObject(console_in, mseconds);
@@ -181,6 +226,39 @@ device_kbhit(uint64_t useconds)
     return false;
 }
 
+bool
+device_kbhit(uint64_t useconds)
+{
+    if (journal_replaying(journal))
+        return journal_int(journal, JOURNAL_KBHIT, false);
+    return journal_int(journal, JOURNAL_KBHIT, console_kbhit(useconds));
+}
+
+bool
+device_tick(uint64_t period)
+{
+    if (journal_replaying(journal))
+        return journal_int(journal, JOURNAL_TICK, false);
+    bool hit = console_kbhit(period - device_uepoch() % period);
+    return journal_int(journal, JOURNAL_TICK, hit);
+}
+
+/**
+ * Base periods of game time the last frame tick covered. The console
+ * keeps up with every frame, so there is always one.
+ */
+int
+device_frames(void)
+{
+    return journal_int(journal, JOURNAL_FRAMES, 1);
+}
+
+bool
+device_resized(void)
+{
+    return journal_int(journal, JOURNAL_RESIZED, false);
+}
+
 /* http://stackoverflow.com/a/4568846 */
 uint64_t
 device_uepoch(void)
@@ -208,6 +286,8 @@ device_terminal_size(int *width, int *height)
     GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi);
     *width = csbi.srWindow.Right - csbi.srWindow.Left + 1;
     *height = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+    *width = journal_int(journal, JOURNAL_WIDTH, *width);
+    *height = journal_int(journal, JOURNAL_HEIGHT, *height);
 }
 
 void
@@ -225,4 +305,18 @@ device_entropy(void *buffer, size_t size)
     }
     if (h)
         CryptReleaseContext(h, 0);
+    journal_bytes(journal, JOURNAL_ENTROPY, buffer, size);
+}
+
+void
+device_journal(struct journal *j)
+{
+    journal_close(journal);
+    journal = j;
+}
+
+bool
+device_headless(void)
+{
+    return false; // headless replay needs the Unix device
 }
@@ -1,24 +1,408 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
 #include <unistd.h>
 #include <termios.h>
 #include <sys/time.h>
-#include <sys/select.h>
+#include <fcntl.h>
 #include <sys/ioctl.h>
-#include "device.h"
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+#include "device_unix.h"
+#include "display.h"
+#include "journal.h"
 #include "rand.h"
 #include "utf.h"
 
 #define FONT_INVALID {-1, -1, -1, -1}
-static font_t device_font_last = FONT_INVALID;
-static int cursor_x, cursor_y;
+#define ESC_TIMEOUT 50000 // default usec to wait for the rest of a sequence
+#define RATE_INTERVAL 250000 // usec between drain rate samples
+#define BACKLOG_MIN 256      // bytes that may always be queued
+#define PERIOD_MAX 2000000   // slowest adaptive frame period, usec
+
 struct termios termios_orig;
 
+/* The local terminal's event loop: a frame ticker and signals. */
+static struct {
+    sigset_t sigmask_orig;
+    int sigfd;
+    int timerfd;
+    uint64_t esc_timeout;
+} loop = {.sigfd = -1, .timerfd = -1, .esc_timeout = ESC_TIMEOUT};
+
+/* Extra descriptors serviced while the local terminal waits. The
+ * first four poll slots are reserved for the terminal itself. */
+#define WATCH_BASE 4
+static struct {
+    int count, cap;
+    struct pollfd *fds;
+    struct {
+        watch_fn fn;
+        void *arg;
+    } *watches;
+} watch;
+
+static terminal_t local = {
+    .fd_in = STDIN_FILENO,
+    .fd_out = STDOUT_FILENO,
+    .font_last = FONT_INVALID
+};
+static __thread terminal_t *device = &local; // selected per thread
+
+uint64_t
+device_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * UINT64_C(1000000) + ts.tv_nsec / 1000;
+}
+
+terminal_t *
+device_select(terminal_t *t)
+{
+    terminal_t *previous = device;
+    device = t;
+    return previous;
+}
+
+terminal_t *
+device_current(void)
+{
+    return device;
+}
+
+/**
+ * Poll FD for EVENTS while the local terminal waits, replacing any
+ * previous watch on FD. Zero EVENTS removes the watch.
+ */
+void
+device_watch(int fd, short events, watch_fn fn, void *arg)
+{
+    int i = 0;
+    while (i < watch.count && watch.fds[WATCH_BASE + i].fd != fd)
+        i++;
+    if (!events) {
+        if (i < watch.count) {
+            watch.count--;
+            watch.fds[WATCH_BASE + i] = watch.fds[WATCH_BASE + watch.count];
+            watch.watches[i] = watch.watches[watch.count];
+        }
+        return;
+    }
+    if (i == watch.count) {
+        if (watch.count == watch.cap) {
+            watch.cap = watch.cap ? watch.cap * 2 : 16;
+            size_t fds_size = (WATCH_BASE + watch.cap) * sizeof(*watch.fds);
+            watch.fds = realloc(watch.fds, fds_size);
+            watch.watches = realloc(watch.watches,
+                                    watch.cap * sizeof(*watch.watches));
+        }
+        watch.count++;
+    }
+    watch.fds[WATCH_BASE + i] = (struct pollfd){fd, events, 0};
+    watch.watches[i].fn = fn;
+    watch.watches[i].arg = arg;
+}
+
+void
+terminal_init(terminal_t *t, int fd_in, int fd_out)
+{
+    memset(t, 0, sizeof(*t));
+    t->fd_in = fd_in;
+    t->fd_out = fd_out;
+    t->width = DISPLAY_WIDTH;
+    t->height = DISPLAY_HEIGHT;
+    t->font_last = (font_t)FONT_INVALID;
+    input_init(&t->input);
+}
+
+void
+terminal_free(terminal_t *t)
+{
+    journal_close(t->journal);
+    t->journal = NULL;
+    free(t->output);
+    t->output = NULL;
+    t->output_len = t->output_cap = t->tee_start = 0;
+}
+
+/**
+ * Write as much pending output as the descriptor accepts without
+ * blocking. Returns true once the buffer is empty.
+ */
+bool
+terminal_flush(terminal_t *t)
+{
+    size_t done = 0;
+    while (done < t->output_len) {
+        ssize_t r = write(t->fd_out, t->output + done, t->output_len - done);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            break;
+        done += r;
+    }
+    if (done > t->tee_start) {
+        /* Part of the frame in progress is going out before it was
+         * teed: hand it over first, so viewers see every byte. */
+        if (t->tee)
+            t->tee(t->tee_arg, t->output + t->tee_start,
+                   done - t->tee_start);
+        t->tee_start = done;
+    }
+    t->tee_start -= done;
+    t->sent += done;
+    t->output_len -= done;
+    memmove(t->output, t->output + done, t->output_len);
+    return t->output_len == 0;
+}
+
+void
+terminal_write(terminal_t *t, const void *buf, size_t len)
+{
+    if (t->output_len + len > t->output_cap) {
+        size_t cap = t->output_cap ? t->output_cap : 4096;
+        while (cap < t->output_len + len)
+            cap *= 2;
+        t->output = realloc(t->output, cap);
+        t->output_cap = cap;
+    }
+    memcpy(t->output + t->output_len, buf, len);
+    t->output_len += len;
+    t->frame_len += len;
+}
+
+/**
+ * Returns the bytes written but not yet taken by the far side, and
+ * updates the estimate of how fast it takes them. The rate is only
+ * measured while the link stays saturated; otherwise it is probed
+ * upward.
+ */
+static size_t
+terminal_backlog(terminal_t *t)
+{
+    int queued = 0;
+    if (ioctl(t->fd_out, TIOCOUTQ, &queued) < 0)
+        queued = 0; // not a socket or tty, count only our own buffer
+    size_t backlog = t->output_len + queued;
+    uint64_t now = device_now();
+    uint64_t dt = now - t->sample_time;
+    if (dt >= RATE_INTERVAL) {
+        uint64_t drained = t->sent - queued;
+        if (t->saturated && backlog) {
+            double rate = (drained - t->drained) * 1e6 / dt;
+            t->rate = t->rate ? t->rate * 0.75 + rate * 0.25 : rate;
+        } else if (t->rate && t->base) {
+            /* Probe upward, but only as far as twice what frames at
+             * the period asked for need, so a link that slows down
+             * again is caught within a few samples. */
+            double enough = 2e6 * t->frame_size / t->base;
+            if (t->rate < enough)
+                t->rate = t->rate * 1.25 < enough ? t->rate * 1.25 : enough;
+        }
+        t->drained = drained;
+        t->sample_time = now;
+        t->saturated = backlog > 0;
+    }
+    return backlog;
+}
+
+/**
+ * The frame period the link can sustain, no shorter than PERIOD.
+ */
+static uint64_t
+terminal_period(terminal_t *t, uint64_t period)
+{
+    if (t->rate > 0) {
+        double needed = t->frame_size / t->rate * 1e6;
+        if (needed > PERIOD_MAX)
+            return PERIOD_MAX;
+        if (needed > period)
+            return (uint64_t)(needed / 10000) * 10000 + 10000;
+    }
+    return period;
+}
+
+static void
+out_write(const void *buf, size_t len)
+{
+    terminal_write(device, buf, len);
+}
+
+static void
+out_printf(const char *format, ...)
+{
+    char buf[256];
+    va_list ap;
+    va_start(ap, format);
+    int len = vsnprintf(buf, sizeof(buf), format, ap);
+    va_end(ap);
+    out_write(buf, len < (int)sizeof(buf) ? len : (int)sizeof(buf) - 1);
+}
+
+/**
+ * The local player is gone: restore the terminal and exit, leaving a
+ * persistent game to be saved by atexit().
+ */
+static void
+loop_hangup(void)
+{
+    device_free();
+    exit(EXIT_FAILURE);
+}
+
+static void
+loop_signal(void)
+{
+    struct signalfd_siginfo info;
+    while (read(loop.sigfd, &info, sizeof(info)) == sizeof(info)) {
+        switch (info.ssi_signo) {
+        case SIGWINCH:
+            local.resized = true;
+            break;
+        default:
+            /* SIGINT, SIGTERM, SIGHUP */
+            loop_hangup();
+        }
+    }
+}
+
+static void
+loop_read(void)
+{
+    uint8_t *p;
+    size_t avail;
+    while ((avail = input_space(&local.input, &p)) > 0) {
+        ssize_t r = read(local.fd_in, p, avail);
+        if (r == 0 || (r < 0 && errno != EAGAIN && errno != EINTR))
+            local.hangup = true; // end of input, or the terminal is gone
+        if (r <= 0)
+            break;
+        input_commit(&local.input, r);
+        local.read_time = device_now();
+        if ((size_t)r < avail)
+            break;
+    }
+}
+
+/**
+ * Block the local terminal on input, signals, and the frame timer.
+ */
+static bool
+loop_block(uint64_t wake, bool tick)
+{
+    struct pollfd fixed[WATCH_BASE] = {
+        {local.fd_in,  POLLIN, 0},
+        {loop.sigfd,   POLLIN, 0},
+        {loop.timerfd, tick ? POLLIN : 0, 0},
+        {local.fd_out, local.output_len ? POLLOUT : 0, 0},
+    };
+    struct pollfd *fds = fixed;
+    if (watch.count) {
+        fds = watch.fds;
+        memcpy(fds, fixed, sizeof(fixed));
+    }
+    struct timespec ts, *timeout = NULL;
+    if (wake) {
+        uint64_t now = device_now();
+        uint64_t usec = wake > now ? wake - now : 0;
+        ts = (struct timespec){usec / 1000000, usec % 1000000 * 1000};
+        timeout = &ts;
+    }
+    if (ppoll(fds, WATCH_BASE + watch.count, timeout, NULL) <= 0)
+        return false;
+    memcpy(fixed, fds, sizeof(fixed));
+    fds = fixed;
+    for (int i = 0; i < watch.count;) {
+        struct pollfd *p = watch.fds + WATCH_BASE + i;
+        int fd = p->fd;
+        short revents = p->revents;
+        p->revents = 0;
+        if (revents)
+            watch.watches[i].fn(watch.watches[i].arg, fd, revents);
+        /* A callback that drops its own watch swaps the last one into
+         * this slot, which still needs a look. */
+        if (i == watch.count || watch.fds[WATCH_BASE + i].fd == fd)
+            i++;
+    }
+    if (fds[3].revents)
+        terminal_flush(&local);
+    if (fds[0].revents)
+        loop_read();
+    if (fds[1].revents)
+        loop_signal();
+    if (fds[2].revents) {
+        uint64_t expirations;
+        return read(loop.timerfd, &expirations, sizeof(expirations)) > 0;
+    }
+    return false;
+}
+
+/**
+ * Wait for a key, DEADLINE (0 for none), or with TICK the frame timer
+ * or a terminal resize. Returns true if a key is ready. A partial
+ * sequence counts as ready once the escape timeout has passed without
+ * more bytes arriving.
+ */
+static bool
+loop_wait(uint64_t deadline, bool tick)
+{
+    terminal_t *t = device;
+    for (;;) {
+        uint64_t now = device_now();
+        uint64_t wake = deadline;
+        int key = input_peek(&t->input);
+        if (key == INPUT_PARTIAL) {
+            uint64_t flush = t->read_time + loop.esc_timeout;
+            if (now >= flush)
+                return true;
+            if (!wake || flush < wake)
+                wake = flush;
+        } else if (key != INPUT_NONE) {
+            return true;
+        } else if (t == &local && t->hangup) {
+            loop_hangup(); // no more keys are coming
+        }
+        if (deadline && now >= deadline)
+            return false;
+        bool ticked = t->wait ? t->wait(t, wake, tick) : loop_block(wake, tick);
+        if (ticked || (tick && t->resized))
+            return input_peek(&t->input) >= 0;
+    }
+}
+
+/**
+ * Wait as loop_wait() does, with game time stopped: a screen waiting
+ * on a key has the game paused.
+ */
+static bool
+loop_wait_paused(uint64_t deadline)
+{
+    terminal_t *t = device;
+    uint64_t start = device_now();
+    bool ready = loop_wait(deadline, false);
+    if (t->clock)
+        t->clock += device_now() - start;
+    return ready;
+}
+
 void
 device_init(void)
 {
-    printf("\e[2J");
+    out_printf("\e[2J\e[?25l");
+    if (device != &local)
+        return;
+
+    /* A private non-blocking description, leaving stdin's alone. */
+    int fd = open("/proc/self/fd/1", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd >= 0)
+        local.fd_out = fd;
+
     tcgetattr(STDIN_FILENO, &termios_orig);
     struct termios raw;
     memcpy(&raw, &termios_orig, sizeof(raw));
@@ -27,89 +411,221 @@ device_init(void)
     raw.c_lflag &= ~(ECHO|ECHONL|ICANON|ISIG|IEXTEN);
     raw.c_cflag &= ~(CSIZE|PARENB);
     raw.c_cflag |= CS8;
+    raw.c_cc[VMIN] = 0; // reads never block, poll() does the waiting
+    raw.c_cc[VTIME] = 0;
     tcsetattr(STDIN_FILENO, TCSANOW, &raw);
-    fputs("\e[?25l", stdout);
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGWINCH);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGHUP);
+    sigprocmask(SIG_BLOCK, &mask, &loop.sigmask_orig);
+    loop.sigfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    loop.timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    local.period = 0;
+    input_init(&local.input);
+    const char *escdelay = getenv("ESCDELAY"); // milliseconds, as in curses
+    if (escdelay)
+        loop.esc_timeout = atol(escdelay) * 1000;
 }
 
 void
 device_free(void)
 {
+    out_printf("\e[?25h\e[m\n");
+    device_flush();
+    journal_close(device->journal);
+    device->journal = NULL;
+    if (device != &local)
+        return;
+    while (!terminal_flush(&local)) {
+        struct pollfd fd = {local.fd_out, POLLOUT, 0};
+        int r = poll(&fd, 1, -1);
+        if ((r < 0 && errno != EINTR) || fd.revents & (POLLERR | POLLHUP))
+            break; // nobody is left to read it
+    }
+    if (local.fd_out != STDOUT_FILENO)
+        close(local.fd_out);
+    local.fd_out = STDOUT_FILENO;
     tcsetattr(STDIN_FILENO, TCSANOW, &termios_orig);
-    printf("\e[?25h\e[m\n");
+    if (loop.timerfd >= 0)
+        close(loop.timerfd);
+    if (loop.sigfd >= 0)
+        close(loop.sigfd);
+    loop.timerfd = loop.sigfd = -1;
+    sigprocmask(SIG_SETMASK, &loop.sigmask_orig, NULL);
 }
 
 void
 device_move(int x, int y)
 {
-    cursor_x = x;
-    cursor_y = y;
-    device_font_last = (font_t)FONT_INVALID;
-    printf("\e[%d;%dH", y + 1, x + 1);
+    device->cursor_x = x;
+    device->cursor_y = y;
+    device->font_last = (font_t)FONT_INVALID;
+    out_printf("\e[%d;%dH", y + 1, x + 1);
 }
 
 void
 device_cursor_get(int *x, int *y)
 {
     if (x)
-        *x = cursor_x;
+        *x = device->cursor_x;
     if (y)
-        *y = cursor_y;
+        *y = device->cursor_y;
 }
 
 void
 device_putc(font_t font, uint16_t c)
 {
     uint8_t utf8[7];
-    utf8[utf32_to_8(c, utf8)] = '\0';
-    if (font_equal(device_font_last, font))
-        fputs((char *)utf8, stdout);
-    else
-        printf("\e[%d;%dm%s",
-               font.fore + 30 + (font.fore_bright ? 60 : 0),
-               font.back + 40 + (font.back_bright ? 60 : 0),
-               (char *)utf8);
-    device_font_last = font;
-    cursor_x++;
+    size_t len = utf32_to_8(c, utf8);
+    if (!font_equal(device->font_last, font))
+        out_printf("\e[%d;%dm",
+                   font.fore + 30 + (font.fore_bright ? 60 : 0),
+                   font.back + 40 + (font.back_bright ? 60 : 0));
+    out_write(utf8, len);
+    device->font_last = font;
+    device->cursor_x++;
 }
 
 void
 device_flush(void)
 {
-    fflush(stdout);
+    terminal_t *t = device;
+    if (t->tee && t->output_len > t->tee_start)
+        t->tee(t->tee_arg, t->output + t->tee_start,
+               t->output_len - t->tee_start);
+    t->tee_start = t->output_len;
+    if (t->frame_len) {
+        if (t->frame_size)
+            t->frame_size = t->frame_size * 0.9 + t->frame_len * 0.1;
+        else
+            t->frame_size = t->frame_len;
+        t->frame_len = 0;
+    }
+    terminal_flush(t); // the event loop drains the rest
+}
+
+bool
+device_writable(void)
+{
+    terminal_t *t = device;
+    if (journal_replaying(t->journal))
+        return journal_int(t->journal, JOURNAL_WRITABLE, true);
+    terminal_flush(t);
+    size_t backlog = terminal_backlog(t);
+    bool writable = backlog <= BACKLOG_MIN || backlog <= t->frame_size;
+    return journal_int(t->journal, JOURNAL_WRITABLE, writable);
 }
 
 int
 device_getch(void)
 {
-    int r;
-    unsigned char c;
-    if ((r = read(STDIN_FILENO, &c, sizeof(c))) < 0) {
-        return r;
-    } else if (c == '\e') {
-        if (!device_kbhit(0))
-            return c;
-        unsigned char code[2];
-        read(STDIN_FILENO, code, sizeof(code));
-        return code[1] + 256;
-    } else {
-        if (c == 3) {
-            /* SIGINT */
-            device_free();
-            exit(EXIT_FAILURE);
-        }
-        return c;
+    terminal_t *t = device;
+    if (journal_replaying(t->journal))
+        return journal_int(t->journal, JOURNAL_GETCH, 0);
+    while (!loop_wait_paused(0));
+    int c = input_next(&t->input, true);
+    if (c == 3) {
+        /* SIGINT */
+        if (t == &local)
+            loop_hangup();
+        t->hangup = true;
+        t->wait(t, 0, false); // never returns
     }
+    return journal_int(t->journal, JOURNAL_GETCH, c);
+}
+
+bool
+device_motion(int *dx, int *dy)
+{
+    terminal_t *t = device;
+    int mx = 0, my = 0;
+    bool any = false;
+    if (!journal_replaying(t->journal)) {
+        if (t == &local)
+            loop_read();
+        any = input_motion(&t->input, &mx, &my);
+    }
+    if (!journal_int(t->journal, JOURNAL_MOTION, any))
+        return false;
+    *dx += journal_int(t->journal, JOURNAL_MOTION_X, mx);
+    *dy += journal_int(t->journal, JOURNAL_MOTION_Y, my);
+    return true;
 }
 
-/* http://stackoverflow.com/questions/448944/c-non-blocking-keyboard-input */
 bool
 device_kbhit(uint64_t useconds)
 {
-    struct timeval tv = {useconds / 1000000, useconds % 1000000};
-    fd_set fds;
-    FD_ZERO(&fds);
-    FD_SET(STDIN_FILENO, &fds);
-    return select(1, &fds, NULL, NULL, &tv) > 0;
+    terminal_t *t = device;
+    if (journal_replaying(t->journal))
+        return journal_int(t->journal, JOURNAL_KBHIT, false);
+    bool hit = loop_wait_paused(device_now() + useconds);
+    return journal_int(t->journal, JOURNAL_KBHIT, hit);
+}
+
+bool
+device_tick(uint64_t period)
+{
+    terminal_t *t = device;
+    if (journal_replaying(t->journal))
+        return journal_int(t->journal, JOURNAL_TICK, false);
+    t->base = period;
+    period = terminal_period(t, period);
+    if (t == &local && period != t->period) {
+        /* Align ticks to multiples of the period. */
+        uint64_t next = device_now() / period * period + period;
+        struct itimerspec spec = {
+            .it_interval = {period / 1000000, period % 1000000 * 1000},
+            .it_value = {next / 1000000, next % 1000000 * 1000}
+        };
+        timerfd_settime(loop.timerfd, TFD_TIMER_ABSTIME, &spec, NULL);
+    }
+    t->period = period;
+    bool ready = loop_wait(0, true);
+
+    /* Count the time since the last tick in whole base periods,
+     * carrying the remainder, however long the link made it. */
+    uint64_t now = device_now();
+    uint64_t elapsed = t->clock ? now - t->clock : t->base;
+    uint64_t frames = elapsed / t->base;
+    t->clock = now - elapsed % t->base;
+    if (frames > PERIOD_MAX / t->base) {
+        frames = PERIOD_MAX / t->base; // a stall is not caught up
+        t->clock = now;
+    }
+    t->frames = frames;
+    return journal_int(t->journal, JOURNAL_TICK, ready);
+}
+
+/**
+ * Base periods of game time the last frame tick covered. The adaptive
+ * period only holds back what is drawn: the game keeps to the clock,
+ * taking several periods' worth of steps in one frame over a slow
+ * link. Time spent waiting on a key in device_getch() is not counted.
+ */
+int
+device_frames(void)
+{
+    terminal_t *t = device;
+    int frames = journal_replaying(t->journal) ? 1 : t->frames;
+    return journal_int(t->journal, JOURNAL_FRAMES, frames);
+}
+
+bool
+device_resized(void)
+{
+    terminal_t *t = device;
+    bool resized = t->resized && !journal_replaying(t->journal);
+    if (journal_int(t->journal, JOURNAL_RESIZED, resized)) {
+        t->resized = false;
+        t->font_last = (font_t)FONT_INVALID;
+        out_printf("\e[2J");
+        return true;
+    }
+    return false;
 }
 
 uint64_t
@@ -123,21 +639,30 @@ device_uepoch(void)
 void
 device_title(const char *title)
 {
-    printf("\e]2;%s\a", title);
+    out_printf("\e]2;%s\a", title);
 }
 
 void
 device_terminal_size(int *width, int *height)
 {
-    struct winsize w;
-    ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
-    *width = w.ws_col;
-    *height = w.ws_row;
+    terminal_t *t = device;
+    if (t == &local && !journal_replaying(t->journal)) {
+        struct winsize w;
+        ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
+        local.width = w.ws_col;
+        local.height = w.ws_row;
+    }
+    *width = journal_int(t->journal, JOURNAL_WIDTH, t->width);
+    *height = journal_int(t->journal, JOURNAL_HEIGHT, t->height);
 }
 
 void
 device_entropy(void *buffer, size_t size)
 {
+    if (journal_replaying(device->journal)) {
+        journal_bytes(device->journal, JOURNAL_ENTROPY, buffer, size);
+        return;
+    }
     FILE *in = fopen("/dev/urandom", "r");
     if (in == NULL || fread(buffer, size, 1, in) != 1) {
         /* Fallback */
@@ -147,4 +672,31 @@ device_entropy(void *buffer, size_t size)
     }
     if (in)
         fclose(in);
+    journal_bytes(device->journal, JOURNAL_ENTROPY, buffer, size);
+}
+
+/**
+ * Attach a journal to the current terminal, which then owns it.
+ */
+void
+device_journal(struct journal *journal)
+{
+    journal_close(device->journal);
+    device->journal = journal;
+}
+
+/**
+ * Switch to a terminal that discards its output, for replaying
+ * journals without a real terminal.
+ */
+bool
+device_headless(void)
+{
+    static __thread terminal_t headless;
+    int fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    terminal_init(&headless, -1, fd);
+    device_select(&headless);
+    return true;
 }
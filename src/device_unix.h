@@ -0,0 +1,57 @@
+/**
+ * Unix device internals shared with the network server. A terminal is
+ * a pair of file descriptors with its own output buffer, input
+ * decoder, and cursor state. The device_* API always acts on the
+ * currently selected terminal.
+ */
+#pragma once
+
+#include "device.h"
+#include "input.h"
+
+typedef struct terminal {
+    int fd_in, fd_out;
+    int width, height;
+    bool resized;
+    bool hangup;        // the user asked to disconnect, or hung up
+    uint64_t period;    // frame tick period, usec
+    uint64_t base;      // the period asked for, before adapting to the link
+    uint64_t clock;     // game time has been counted up to here
+    int frames;         // base periods of game time the last tick covered
+    uint64_t read_time; // when input last arrived (monotonic usec)
+    input_t input;
+    font_t font_last;
+    int cursor_x, cursor_y;
+    char *output;
+    size_t output_len, output_cap;
+    /* Backpressure accounting */
+    uint64_t sent;        // bytes handed to the kernel
+    uint64_t drained;     // bytes the far side had taken at sample_time
+    uint64_t sample_time;
+    bool saturated;       // bytes were queued at sample_time
+    double rate;          // drain rate estimate, bytes/sec (0 unknown)
+    double frame_size;    // average bytes per frame
+    size_t frame_len;     // bytes in the frame being encoded
+    size_t tee_start;     // output not yet handed to the tee begins here
+    /* Block until something happens or WAKE (0 for never). Returns
+     * true if a frame tick was due. NULL for the local terminal. */
+    bool (*wait)(struct terminal *, uint64_t wake, bool tick);
+    void *arg;
+    /* Receives a copy of all output, a frame at a time unless part of
+     * one has to go out early. */
+    void (*tee)(void *, const char *, size_t);
+    void *tee_arg;
+    struct journal *journal; // owned, closed with the terminal
+} terminal_t;
+
+/* Called from the local event loop when FD is ready. */
+typedef void (*watch_fn)(void *arg, int fd, short revents);
+
+void        terminal_init(terminal_t *, int fd_in, int fd_out);
+void        terminal_free(terminal_t *);
+void        terminal_write(terminal_t *, const void *, size_t);
+bool        terminal_flush(terminal_t *);
+terminal_t *device_select(terminal_t *);
+terminal_t *device_current(void);
+void        device_watch(int fd, short events, watch_fn, void *arg);
+uint64_t    device_now(void);
@@ -1,30 +1,74 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <string.h>
 #include <ctype.h>
 #include <assert.h>
 #include "display.h"
+#include "record.h"
 #include "utf.h"
 
-static struct {
+#define DISPLAY_RETRY 50000 // usec between attempts to send a held frame
+
+struct display {
     struct {
         uint16_t c;
         font_t font;
     } current[DISPLAY_WIDTH][DISPLAY_HEIGHT];
     panel_t base;
     panel_t *panels;
-} display;
+    bool held; // a frame was skipped while the device was busy
+    record_t *record;
+};
+
+/* The selected display, per thread. Every thread starts out on the
+ * default display, so threads running their own games select their
+ * own first. */
+static display_t display_default;
+static __thread display_t *display = &display_default;
+
+display_t *
+display_create(void)
+{
+    return calloc(sizeof(display_t), 1);
+}
+
+void
+display_destroy(display_t *d)
+{
+    record_close(d->record);
+    free(d);
+}
+
+display_t *
+display_select(display_t *d)
+{
+    display_t *previous = display;
+    display = d;
+    return previous;
+}
+
+/**
+ * Record every frame sent from now on. The display owns the recorder
+ * and closes it in display_free().
+ */
+void
+display_record(record_t *r)
+{
+    record_close(display->record);
+    display->record = r;
+}
 
 void
 display_init(void)
 {
     device_init();
-    panel_init(&display.base, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    panel_init(&display->base, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
     for (int y = 0; y < DISPLAY_HEIGHT; y++)
         for (int x = 0; x < DISPLAY_WIDTH; x++)
-            panel_putc(&display.base, x, y, FONT_DEFAULT, ' ');
-    display.panels = &display.base;
+            panel_putc(&display->base, x, y, FONT_DEFAULT, ' ');
+    display->panels = &display->base;
     display_refresh();
 }
 
@@ -32,72 +76,107 @@ void
 display_free()
 {
     device_move(0, DISPLAY_HEIGHT);
-    panel_free(&display.base);
+    record_close(display->record);
+    display->record = NULL;
+    panel_free(&display->base);
     device_free();
-    assert(display.panels == &display.base);
+    assert(display->panels == &display->base);
 }
 
 void
 display_push(panel_t *p)
 {
-    p->next = display.panels;
-    display.panels = p;
+    p->next = display->panels;
+    display->panels = p;
 }
 
 void
 display_pop(void)
 {
-    panel_t *discard = display.panels;
-    display.panels = display.panels->next;
+    panel_t *discard = display->panels;
+    display->panels = display->panels->next;
     discard->next = NULL;
 }
 
 void
 display_pop_free(void)
 {
-    panel_t *discard = display.panels;
+    panel_t *discard = display->panels;
     display_pop();
     panel_free(discard);
 }
 
+/**
+ * Send the difference between the panel stack and what the device last
+ * received. While the device is still busy with earlier output, the
+ * frame is held back instead, so later frames fold into one diff.
+ */
 void
 display_refresh(void)
 {
     int cx = 0;
     int cy = 0;
+    if (device_resized())
+        display_invalidate();
+    display->held = !device_writable();
+    if (display->held)
+        return;
     device_move(cx, cy);
     for (int y = 0; y < DISPLAY_HEIGHT; y++) {
         for (int x = 0; x < DISPLAY_WIDTH; x++) {
-            panel_t *p = display.panels;
+            panel_t *p = display->panels;
             while (p->tiles[x][y].transparent)
                 p = p->next;
-            uint16_t oldc = display.current[x][y].c;
+            uint16_t oldc = display->current[x][y].c;
             uint16_t newc = p->tiles[x][y].c;
-            font_t oldf = display.current[x][y].font;
+            font_t oldf = display->current[x][y].font;
             font_t newf = p->tiles[x][y].font;
             if (oldc != newc || !font_equal(oldf, newf)) {
                 if (cx != x || cy != y)
                     device_move(cx = x, cy = y);
                 device_putc(newf, newc);
-                display.current[x][y].font = newf;
-                display.current[x][y].c = newc;
+                display->current[x][y].font = newf;
+                display->current[x][y].c = newc;
+                if (display->record)
+                    record_cell(display->record, x, y, newf, newc);
                 cx++;
             }
         }
     }
+    if (display->record)
+        record_frame(display->record, device_uepoch());
     device_flush();
 }
 
 void
 display_invalidate(void)
 {
-    memset(display.current, 0, sizeof(display.current));
+    memset(display->current, 0, sizeof(display->current));
+}
+
+/**
+ * Send every cell the device last received, as a keyframe for a
+ * terminal that has seen none of the earlier diffs.
+ */
+void
+display_repaint(void)
+{
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        device_move(0, y);
+        for (int x = 0; x < DISPLAY_WIDTH; x++) {
+            uint16_t c = display->current[x][y].c;
+            device_putc(display->current[x][y].font, c ? c : ' ');
+        }
+    }
+    device_flush();
 }
 
 int
 display_getch(void)
 {
     display_refresh();
+    while (display->held && !device_kbhit(DISPLAY_RETRY))
+        display_refresh();
     return device_getch();
 }
 
@@ -157,26 +236,6 @@ panel_puts(panel_t *p, int x, int y, font_t font, const char *s)
 
 }
 
-static inline bool
-is_color_directive(const char *p)
-{
-    return p[0] && strchr("rgbcmykwRGBCMYKW", p[0]) &&
-           p[1] && strchr("rgbcmykwRGBCMYKW", p[1]) &&
-           p[2] == '{';
-}
-
-static inline font_t
-font_decode(const char *s)
-{
-    font_t font;
-    const char *colors = "krgybmcw";
-    font.fore = strchr(colors, tolower((int)s[0])) - colors;
-    font.back = strchr(colors, tolower((int)s[1])) - colors;
-    font.fore_bright = isupper((int)s[0]);
-    font.back_bright = isupper((int)s[1]);
-    return font;
-}
-
 void
 panel_printf(panel_t *p, int x, int y, const char *format, ...)
 {
@@ -209,6 +268,195 @@ panel_printf(panel_t *p, int x, int y, const char *format, ...)
     }
 }
 
+/* What a template slot takes from the argument list. */
+enum slot {
+    SLOT_NONE, // fixed text
+    SLOT_INT,
+    SLOT_LONG,
+    SLOT_LLONG,
+    SLOT_SIZE,
+    SLOT_DOUBLE,
+    SLOT_STRING,
+    SLOT_POINTER
+};
+
+/* A run of glyphs in one font: fixed text, or one conversion. */
+struct template_run {
+    font_t font;
+    enum slot slot;
+    uint16_t start, length; // in glyphs[], for fixed text
+    char spec[16];          // the conversion, for a slot
+};
+
+struct template_code {
+    unsigned count;
+    uint16_t glyphs[DISPLAY_WIDTH];
+    struct template_run runs[];
+};
+
+/**
+ * Read the conversion at S into RUN, returning the length of it.
+ */
+static size_t
+template_slot(struct template_run *run, const char *s)
+{
+    size_t n = 1 + strspn(s + 1, "-+ #0123456789.");
+    int longs = 0;
+    bool size = false;
+    for (; strchr("hlz", s[n]); n++) {
+        longs += s[n] == 'l';
+        size |= s[n] == 'z';
+    }
+    char conversion = s[n++];
+    assert(n < sizeof(run->spec) && conversion);
+    if (strchr("diouxXc", conversion))
+        run->slot = size ? SLOT_SIZE :
+                    longs == 2 ? SLOT_LLONG :
+                    longs == 1 ? SLOT_LONG : SLOT_INT;
+    else if (strchr("eEfFgGaA", conversion))
+        run->slot = SLOT_DOUBLE;
+    else if (conversion == 's')
+        run->slot = SLOT_STRING;
+    else if (conversion == 'p')
+        run->slot = SLOT_POINTER;
+    else
+        assert(!"unsupported template conversion");
+    memcpy(run->spec, s, n);
+    run->spec[n] = '\0';
+    return n;
+}
+
+/**
+ * Compile a format the way panel_printf() reads one, directives and
+ * all, except that conversions become slots.
+ */
+static struct template_code *
+template_compile(const char *format)
+{
+    size_t max = strlen(format) + 1; // runs never outnumber bytes
+    struct template_code *code =
+        calloc(sizeof(*code) + max * sizeof(code->runs[0]), 1);
+    struct template_run *run = NULL;
+    unsigned glyphs = 0;
+    int f = 0;
+    font_t font[16] = {FONT_DEFAULT};
+    int nest = 0;
+    for (const char *s = format; *s; s += utf8_charlen((uint8_t)*s)) {
+        uint32_t c;
+        if (is_color_directive(s)) {
+            font[++f] = font_decode(s);
+            s += 2;
+            continue;
+        } else if (*s == '}' && (nest > 0 || f > 0)) {
+            if (nest == 0) {
+                f--;
+                continue;
+            }
+            nest--;
+            c = '}';
+        } else if (*s == '{') {
+            nest++;
+            continue;
+        } else if (*s == '%' && s[1] == '%') {
+            c = *s++;
+        } else if (*s == '%') {
+            run = code->runs + code->count++;
+            run->font = font[f];
+            s += template_slot(run, s) - 1;
+            run = NULL; // fixed text after a slot starts a new run
+            continue;
+        } else {
+            c = utf8_to_32((uint8_t *)s);
+            assert(c <= UINT16_MAX);
+        }
+        if (glyphs == DISPLAY_WIDTH)
+            break;
+        if (!run || !font_equal(run->font, font[f])) {
+            run = code->runs + code->count++;
+            run->font = font[f];
+            run->start = glyphs;
+        }
+        code->glyphs[glyphs++] = c;
+        run->length++;
+    }
+    return code;
+}
+
+/**
+ * Draw a template, a format for panel_printf() compiled the first time
+ * it is drawn, so that drawing it again only formats the arguments.
+ * The arguments are drawn as they are, directives and all.
+ */
+void
+panel_template(panel_t *p, int x, int y, template_t *t, ...)
+{
+    struct template_code *code = t->code;
+    if (!code) {
+        code = template_compile(t->format);
+        if (!__sync_bool_compare_and_swap(&t->code, NULL, code)) {
+            free(code); // another thread got there first
+            code = t->code;
+        }
+    }
+    va_list ap;
+    va_start(ap, t);
+    for (unsigned i = 0; i < code->count; i++) {
+        const struct template_run *run = code->runs + i;
+        if (run->slot == SLOT_NONE) {
+            for (int j = 0; j < run->length; j++)
+                panel_putc(p, x++, y, run->font, code->glyphs[run->start + j]);
+            continue;
+        }
+        char buffer[DISPLAY_WIDTH * 6 + 1];
+        size_t size = sizeof(buffer);
+        switch (run->slot) {
+        case SLOT_NONE:
+            break;
+        case SLOT_INT:
+            snprintf(buffer, size, run->spec, va_arg(ap, int));
+            break;
+        case SLOT_LONG:
+            snprintf(buffer, size, run->spec, va_arg(ap, long));
+            break;
+        case SLOT_LLONG:
+            snprintf(buffer, size, run->spec, va_arg(ap, long long));
+            break;
+        case SLOT_SIZE:
+            snprintf(buffer, size, run->spec, va_arg(ap, size_t));
+            break;
+        case SLOT_DOUBLE:
+            snprintf(buffer, size, run->spec, va_arg(ap, double));
+            break;
+        case SLOT_STRING:
+            snprintf(buffer, size, run->spec, va_arg(ap, const char *));
+            break;
+        case SLOT_POINTER:
+            snprintf(buffer, size, run->spec, va_arg(ap, void *));
+            break;
+        }
+        for (char *s = buffer; *s; s += utf8_charlen((uint8_t)*s)) {
+            uint32_t c = utf8_to_32((uint8_t *)s);
+            assert(c <= UINT16_MAX);
+            panel_putc(p, x++, y, run->font, c);
+        }
+    }
+    va_end(ap);
+}
+
+/**
+ * Draw one line of a compiled text page.
+ */
+void
+panel_text(panel_t *p, int x, int y, const text_t *text, int line)
+{
+    for (int i = text->line[line]; i < text->line[line + 1]; i++) {
+        const struct text_run *run = text->runs + i;
+        const uint16_t *glyphs = text->glyphs + run->start;
+        for (int j = 0; j < run->length; j++)
+            panel_putc(p, x++, y, run->font, glyphs[j]);
+    }
+}
+
 void
 panel_attr(panel_t *p, int x, int y, font_t font)
 {
@@ -273,7 +521,7 @@ panel_strlen(const char *s)
     size_t count = 0;
     for (const char *p = s; *p; p += utf8_charlen((uint8_t) *p)) {
         if (is_color_directive(p))
-            p += 3;
+            p += 2; // the loop steps over the brace
         else if (*p != '}')
             count++;
     }
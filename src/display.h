@@ -1,6 +1,8 @@
 #pragma once
 
 #include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
 #include "device.h"
 
 #define DISPLAY_WIDTH  80
@@ -16,6 +18,35 @@ typedef struct panel {
     struct panel *next;
 } panel_t;
 
+/* A panel_printf() format to be drawn over and over. */
+typedef struct template {
+    const char *format;
+    struct template_code *code; // compiled when first drawn
+} template_t;
+
+#define TEMPLATE(format) {format, 0}
+
+/* A text page compiled from doc/ at build time by textc. */
+struct text_run {
+    font_t font;
+    uint16_t start, length; // in glyphs[]
+};
+
+typedef struct text {
+    int lines;
+    const uint16_t *line; // first run of each line, then the run count
+    const struct text_run *runs;
+    const uint16_t *glyphs;
+} text_t;
+
+typedef struct display display_t;
+struct record;
+
+display_t *display_create(void);
+void       display_destroy(display_t *);
+display_t *display_select(display_t *);
+void       display_record(struct record *);
+
 void display_init(void);
 void display_free(void);
 void display_push(panel_t *);
@@ -23,6 +54,7 @@ void display_pop(void);
 void display_pop_free(void);
 void display_refresh(void);
 void display_invalidate(void);
+void display_repaint(void);
 int  display_getch(void);
 
 void     panel_init(panel_t *, int x, int y, int w, int h);
@@ -32,6 +64,8 @@ void     panel_putc(panel_t *, int x, int y, font_t, uint16_t);
 void     panel_puts(panel_t *, int x, int y, font_t, const char *);
 void     panel_printf(panel_t *, int x, int y, const char *format, ...)
     __attribute__ ((format (printf, 4, 5)));
+void     panel_template(panel_t *, int x, int y, template_t *, ...);
+void     panel_text(panel_t *, int x, int y, const text_t *, int line);
 void     panel_attr(panel_t *, int x, int y, font_t);
 void     panel_erase(panel_t *, int x, int y);
 void     panel_clear(panel_t *);
@@ -40,3 +74,25 @@ void     panel_fill(panel_t *, font_t, uint16_t);
 void     panel_border(panel_t *, font_t);
 
 size_t   panel_strlen(const char *);
+
+/* Colour directives, "Yk{...}", as panel_printf() reads them */
+
+static inline bool
+is_color_directive(const char *p)
+{
+    return p[0] && strchr("rgbcmykwRGBCMYKW", p[0]) &&
+           p[1] && strchr("rgbcmykwRGBCMYKW", p[1]) &&
+           p[2] == '{';
+}
+
+static inline font_t
+font_decode(const char *s)
+{
+    font_t font;
+    const char *colors = "krgybmcw";
+    font.fore = strchr(colors, tolower((int)s[0])) - colors;
+    font.back = strchr(colors, tolower((int)s[1])) - colors;
+    font.fore_bright = isupper((int)s[0]);
+    font.back_bright = isupper((int)s[1]);
+    return font;
+}
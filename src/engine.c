@@ -0,0 +1,21 @@
+#include "engine.h"
+#include "rand.h"
+#ifndef _WIN32
+#include "device_unix.h"
+#endif
+
+/**
+ * Exchange the calling thread's context with E. Swapping the same
+ * context again puts the thread back as it was.
+ */
+void
+engine_swap(engine_t *e)
+{
+    uint64_t saved_rand = rand_state;
+    rand_state = e->rand_state;
+    e->rand_state = saved_rand;
+    e->display = display_select(e->display);
+#ifndef _WIN32
+    e->terminal = device_select(e->terminal);
+#endif
+}
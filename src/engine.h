@@ -0,0 +1,22 @@
+/**
+ * Engine contexts. A game plays against the random state, display and
+ * device terminal selected on its thread, so several games can run in
+ * one process: one per thread, or one per server coroutine swapped in
+ * on a thread. A context bundles those three so they can be swapped
+ * in and out together.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "display.h"
+
+struct terminal;
+
+typedef struct engine {
+    uint64_t rand_state;
+    display_t *display;
+    struct terminal *terminal; // ignored where there is only a console
+} engine_t;
+
+void engine_swap(engine_t *);
@@ -4,6 +4,7 @@
 #include <string.h>
 #include <math.h>
 #include "game.h"
+#include "battle.h"
 #include "rand.h"
 
 static bool
@@ -35,7 +36,7 @@ game_hero_generate(void)
 }
 
 game_t *
-game_create(uint64_t map_seed)
+game_create(uint64_t map_seed, enum map_engine engine, int width, int height)
 {
     game_t *game = calloc(sizeof(*game), 1);
     game->map_seed = map_seed;
@@ -46,12 +47,13 @@ game_create(uint64_t map_seed)
     game->food = INIT_FOOD;
     game->population = INIT_POPULATION;
     game->spawn_rate = INVADER_SPAWN_RATE;
-    game->map = map_generate(map_seed);
-    game->map->high[CASTLE_X][CASTLE_Y].building = C_CASTLE;
+    game->map = map_generate(map_seed, engine, width, height);
+    map_set_building(game->map, CASTLE_X(game->map), CASTLE_Y(game->map),
+                     C_CASTLE);
     game->max_hero = MAX_HERO_INIT;
     for (int i = 0; i < (int)countof(game->squads); i++) {
-        game->squads[i].x = CASTLE_X;
-        game->squads[i].y = CASTLE_Y;
+        game->squads[i].x = CASTLE_X(game->map);
+        game->squads[i].y = CASTLE_Y(game->map);
         game->squads[i].target = -1;
     }
     for (int i = 0; i < HERO_INIT; i++) {
@@ -62,28 +64,249 @@ game_create(uint64_t map_seed)
     return game;
 }
 
+/* A save is the game, a tag, its map's size and engine, then the
+ * map's packed chunks. Older saves are of classic worlds, squares and
+ * all: after an older tag, with the engine after them, or before that
+ * with neither the tag nor the engine, and the squares as below. */
+#define SAVE_TAG "GCOMMAP3"
+#define SAVE_TAG_CLASSIC "GCOMMAP2"
+
+struct save_map {
+    int32_t width, height;
+    int32_t engine;
+    uint32_t length; // of the packed chunks
+};
+
+typedef struct {
+    uint8_t terrain[MAP_HEIGHT][MAP_WIDTH];
+    uint8_t building[MAP_HEIGHT][MAP_WIDTH];
+    int32_t age[MAP_HEIGHT][MAP_WIDTH];
+} classic_squares_t;
+
+typedef struct {
+    uint16_t base;
+    uint16_t building;
+    long building_age;
+} old_square_t;
+
+typedef old_square_t old_squares_t[MAP_WIDTH][MAP_HEIGHT];
+
 bool
 game_save(game_t *game, FILE *out)
 {
-    if (fwrite(game, sizeof(*game), 1, out) != 1)
-        return false;
-    if (fwrite(game->map->high, sizeof(game->map->high), 1, out) != 1)
-        return false;
-    return true;
+    map_t *map = game->map;
+    size_t length = map_pack(map, NULL);
+    struct save_map header = {map->width, map->height, map->engine, length};
+    uint8_t *packed = malloc(length + 1);
+    map_pack(map, packed);
+    bool ok = fwrite(game, sizeof(*game), 1, out) == 1 &&
+        fwrite(SAVE_TAG, 8, 1, out) == 1 &&
+        fwrite(&header, sizeof(header), 1, out) == 1 &&
+        (!length || fwrite(packed, length, 1, out) == 1);
+    free(packed);
+    return ok;
+}
+
+/**
+ * Read the engine at the end of an older save. Saves from before there
+ * was a choice end without one.
+ */
+static enum map_engine
+engine_read(FILE *in)
+{
+    enum map_engine engine;
+    if (fread(&engine, sizeof(engine), 1, in) != 1 || engine != MAP_FBM)
+        engine = MAP_DIAMOND_SQUARE;
+    return engine;
+}
+
+/**
+ * Read the map of a save, its TAG already read, for the world of SEED.
+ */
+static map_t *
+map_read(uint64_t seed, const char *tag, FILE *in)
+{
+    map_t *map = NULL;
+    if (!memcmp(tag, SAVE_TAG, 8)) {
+        struct save_map header;
+        if (fread(&header, sizeof(header), 1, in) != 1)
+            return NULL;
+        int width = header.width;
+        int height = header.height;
+        enum map_engine engine = header.engine;
+        bool classic = width == MAP_WIDTH && height == MAP_HEIGHT;
+        if (!classic && (engine != MAP_FBM ||
+                         width < MAP_WIDTH || width > MAP_MAX ||
+                         height < MAP_HEIGHT || height > MAP_MAX))
+            return NULL;
+        if (engine != MAP_FBM)
+            engine = MAP_DIAMOND_SQUARE;
+        uint8_t *packed = malloc(header.length + 1);
+        if (!header.length || fread(packed, header.length, 1, in) == 1) {
+            map = map_generate(seed, engine, width, height);
+            map_unpack(map, packed, header.length);
+        }
+        free(packed);
+    } else if (!memcmp(tag, SAVE_TAG_CLASSIC, 8)) {
+        classic_squares_t *squares = malloc(sizeof(*squares));
+        if (fread(squares, sizeof(*squares), 1, in) == 1) {
+            map = map_generate(seed, engine_read(in), MAP_WIDTH, MAP_HEIGHT);
+            map_chunk_t *chunk = map->chunk[0]; // all of a classic world
+            for (int y = 0; y < MAP_HEIGHT; y++) {
+                memcpy(chunk->terrain[y], squares->terrain[y], MAP_WIDTH);
+                for (int x = 0; x < MAP_WIDTH; x++) {
+                    map_set_building(map, x, y, squares->building[y][x]);
+                    map_set_age(map, x, y, squares->age[y][x]);
+                }
+            }
+        }
+        free(squares);
+    } else {
+        old_squares_t *old = malloc(sizeof(*old));
+        memcpy(old, tag, 8);
+        if (fread((char *)old + 8, sizeof(*old) - 8, 1, in) == 1) {
+            map = map_generate(seed, engine_read(in), MAP_WIDTH, MAP_HEIGHT);
+            for (int x = 0; x < MAP_WIDTH; x++) {
+                for (int y = 0; y < MAP_HEIGHT; y++) {
+                    map_set_base(map, x, y, (*old)[x][y].base);
+                    map_set_building(map, x, y, (*old)[x][y].building);
+                    map_set_age(map, x, y, (*old)[x][y].building_age);
+                }
+            }
+        }
+        free(old);
+    }
+    return map;
 }
 
 game_t *
-game_load(FILE *out)
+game_load(FILE *in)
 {
     game_t *game = malloc(sizeof(*game));
-    if (fread(game, sizeof(*game), 1, out) == 1) {
-        game->map = map_generate(game->map_seed);
-        if (fread(game->map->high, sizeof(game->map->high), 1, out) == 1)
-            return game;
-    }
+    char tag[8];
+    if (fread(game, sizeof(*game), 1, in) == 1 &&
+        fread(tag, sizeof(tag), 1, in) == 1 &&
+        (game->map = map_read(game->map_seed, tag, in)))
+        return game;
+    free(game);
     return NULL;
 }
 
+/**
+ * Read the map seed and engine of a saved game, leaving the file where
+ * it was.
+ */
+bool
+game_peek_seed(FILE *in, uint64_t *seed, enum map_engine *engine)
+{
+    game_t game;
+    char tag[8];
+    long start = ftell(in);
+    bool ok = fread(&game, sizeof(game), 1, in) == 1 &&
+        fread(tag, sizeof(tag), 1, in) == 1;
+    if (ok && !memcmp(tag, SAVE_TAG, sizeof(tag))) {
+        struct save_map header;
+        ok = fread(&header, sizeof(header), 1, in) == 1;
+        *engine = ok && header.engine == MAP_FBM ? MAP_FBM :
+                  MAP_DIAMOND_SQUARE;
+    } else {
+        if (ok && !memcmp(tag, SAVE_TAG_CLASSIC, sizeof(tag)))
+            ok = !fseek(in, sizeof(classic_squares_t), SEEK_CUR);
+        else if (ok)
+            ok = !fseek(in, sizeof(old_squares_t) - sizeof(tag), SEEK_CUR);
+        *engine = engine_read(in);
+    }
+    fseek(in, start, SEEK_SET);
+    *seed = game.map_seed;
+    return ok;
+}
+
+static uint64_t
+hash(uint64_t h, const void *buf, size_t len)
+{
+    const unsigned char *p = buf;
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ p[i]) * UINT64_C(0x100000001b3);
+    return h;
+}
+
+#define HASH(h, field) hash(h, &(field), sizeof(field))
+
+/**
+ * Fingerprint of the simulation state, field by field so that struct
+ * padding does not take part.
+ */
+uint64_t
+game_hash(game_t *game)
+{
+    uint64_t h = UINT64_C(0xcbf29ce484222325);
+    h = HASH(h, game->map_seed);
+    h = HASH(h, game->time);
+    h = HASH(h, game->speed);
+    h = HASH(h, game->gold);
+    h = HASH(h, game->wood);
+    h = HASH(h, game->food);
+    h = HASH(h, game->population);
+    h = HASH(h, game->spawn_rate);
+    for (int i = 0; i < (int)countof(game->invaders); i++) {
+        invader_t *v = game->invaders + i;
+        h = HASH(h, v->active);
+        h = HASH(h, v->x);
+        h = HASH(h, v->y);
+        h = HASH(h, v->tx);
+        h = HASH(h, v->ty);
+        h = HASH(h, v->type);
+        h = HASH(h, v->rampage_time);
+        h = HASH(h, v->embarked);
+    }
+    for (int i = 0; i < (int)countof(game->squads); i++) {
+        squad_t *s = game->squads + i;
+        h = HASH(h, s->x);
+        h = HASH(h, s->y);
+        h = HASH(h, s->target);
+        h = HASH(h, s->member_count);
+    }
+    h = HASH(h, game->max_hero);
+    for (int i = 0; i < (int)countof(game->heroes); i++) {
+        hero_t *e = game->heroes + i;
+        h = HASH(h, e->active);
+        h = HASH(h, e->name);
+        h = HASH(h, e->hp);
+        h = HASH(h, e->hp_max);
+        h = HASH(h, e->ap);
+        h = HASH(h, e->ap_max);
+        h = HASH(h, e->str);
+        h = HASH(h, e->dex);
+        h = HASH(h, e->mind);
+        h = HASH(h, e->squad);
+    }
+    h = HASH(h, game->events);
+    h = HASH(h, game->apology_given);
+    map_t *map = game->map;
+    if (map->width == MAP_WIDTH && map->height == MAP_HEIGHT) {
+        for (int x = 0; x < MAP_WIDTH; x++) {
+            for (int y = 0; y < MAP_HEIGHT; y++) {
+                /* As the squares were once stored, for older journals */
+                uint16_t base = map_base(map, x, y);
+                uint16_t building = map_building(map, x, y);
+                long age = map_age(map, x, y);
+                h = HASH(h, base);
+                h = HASH(h, building);
+                h = HASH(h, age);
+            }
+        }
+    } else {
+        h = HASH(h, map->width);
+        h = HASH(h, map->height);
+        size_t length = map_pack(map, NULL);
+        uint8_t *packed = malloc(length + 1);
+        map_pack(map, packed);
+        h = hash(h, packed, length);
+        free(packed);
+    }
+    return h;
+}
+
 void
 game_free(game_t *game)
 {
@@ -104,33 +327,43 @@ add_population(game_t *game, long amount)
         game_event_push(game, EVENT_LOSE);
 }
 
+bool
+game_can_afford(game_t *game, yield_t cost)
+{
+    return
+        (cost.food == 0 || game->food >= cost.food) &&
+        (cost.wood == 0 || game->wood >= cost.wood) &&
+        (cost.gold == 0 || game->gold >= cost.gold);
+}
+
 bool
 game_build(game_t *game, uint16_t building, int x, int y)
 {
+    map_t *map = game->map;
     if (building == C_NONE) {
         /* Erase */
-        if (game->map->high[x][y].building != C_NONE) {
-            game->map->high[x][y].building = C_NONE;
+        if (map_building(map, x, y) != C_NONE) {
+            map_set_building(map, x, y, C_NONE);
             return true;
         }
     }
-    if (x < 0 || x >= MAP_WIDTH || y < 0 || y >= MAP_HEIGHT ||
-        game->map->high[x][y].building != C_NONE) {
+    if (x < 0 || x >= map->width || y < 0 || y >= map->height ||
+        map_building(map, x, y) != C_NONE) {
         return false;
     }
 
     bool valid = false;
-    if (x > 0 && game->map->high[x - 1][y].building != C_NONE)
+    if (map_building(map, x - 1, y) != C_NONE)
         valid = true;
-    else if (y > 0 && game->map->high[x][y - 1].building != C_NONE)
+    else if (map_building(map, x, y - 1) != C_NONE)
         valid = true;
-    else if (x + 1 < MAP_WIDTH && game->map->high[x + 1][y].building != C_NONE)
+    else if (map_building(map, x + 1, y) != C_NONE)
         valid = true;
-    else if (y + 1 < MAP_HEIGHT && game->map->high[x][y + 1].building != C_NONE)
+    else if (map_building(map, x, y + 1) != C_NONE)
         valid = true;
     if (valid) {
         valid = false;
-        enum map_base base = game->map->high[x][y].base;
+        enum map_base base = map_base(map, x, y);
         switch (building) {
         case C_NONE:
         case C_CASTLE:
@@ -142,7 +375,8 @@ game_build(game_t *game, uint16_t building, int x, int y)
             break;
         case C_STABLE:
             valid = base == BASE_GRASSLAND;
-            game->max_hero += STABLE_INC;
+            if (valid)
+                game->max_hero += STABLE_INC;
             break;
         case C_HAMLET:
             valid =
@@ -166,11 +400,11 @@ game_build(game_t *game, uint16_t building, int x, int y)
         game->food -= cost.food;
         game->wood -= cost.wood;
         game->gold -= cost.gold;
-        game->map->high[x][y].building = building;
+        map_set_building(map, x, y, building);
         if (building == C_ROAD)
-            game->map->high[x][y].building_age = 0;
+            map_set_age(map, x, y, 0);
         else
-            game->map->high[x][y].building_age = INIT_BUILDING_AGE;
+            map_set_age(map, x, y, INIT_BUILDING_AGE);
     }
     return valid;
 }
@@ -196,7 +430,7 @@ game_unbuild(game_t *game, int x, int y)
         add_population(game, -50);
         return; // don't destroy
     }
-    game->map->high[x][y].building = C_NONE;
+    map_set_building(game->map, x, y, C_NONE);
 }
 
 void
@@ -323,15 +557,19 @@ invader_delete(game_t *game, invader_t *i)
     i->active = false;
 }
 
+/**
+ * A new invader, landing from as far off the castle as a classic world
+ * is wide, whatever the size of GAME's world.
+ */
 static invader_t
-invader_generate(void)
+invader_generate(game_t *game)
 {
     float az = rand_uniform(0, 2 * PI);
     invader_t invader = {
         .active = true,
         .type = I_GOBLIN,
-        .x = cosf(az) * MAP_WIDTH + CASTLE_X,
-        .y = sinf(az) * MAP_HEIGHT + CASTLE_Y,
+        .x = cosf(az) * MAP_WIDTH + CASTLE_X(game->map),
+        .y = sinf(az) * MAP_HEIGHT + CASTLE_Y(game->map),
         .embarked = true
     };
     return invader;
@@ -385,8 +623,8 @@ invader_step(game_t *game, invader_t *i)
     uint16_t target_building = map_building(game->map, i->tx, i->ty);
     if (i->embarked || game->population >= GAME_WIN_POP) {
         if (IS_WATER(base)) {
-            i->tx = CASTLE_X;
-            i->ty = CASTLE_Y;
+            i->tx = CASTLE_X(game->map);
+            i->ty = CASTLE_Y(game->map);
         } else {
             i->embarked = false;
             invader_find_target(game, i);
@@ -427,19 +665,94 @@ invader_step(game_t *game, invader_t *i)
     i->embarked = IS_WATER(base);
 }
 
+/**
+ * Fight the band SQUAD has caught up with. Its first BATTLE_SIDE heroes
+ * fight, and those who fall are gone. Goblins that lose are gone too,
+ * and a squad that does not win falls back to the castle.
+ */
+static void
+squad_battle(game_t *game, squad_t *squad)
+{
+    battle_t battle = {0};
+    battle_fighters_t *h = battle.side + BATTLE_HEROES;
+    battle_fighters_t *g = battle.side + BATTLE_GOBLINS;
+    hero_t *fighters[BATTLE_SIDE];
+    int count = 0;
+    int index = squad - game->squads;
+    for (unsigned i = 0; i < countof(game->heroes); i++) {
+        hero_t *hero = game->heroes + i;
+        if (hero->active && hero->squad == index && count < BATTLE_SIDE) {
+            h->hp[count][0] = hero->hp;
+            h->ap[count][0] = hero->ap;
+            h->str[count][0] = hero->str;
+            h->dex[count][0] = hero->dex;
+            h->mind[count][0] = hero->mind;
+            fighters[count++] = hero;
+        }
+    }
+    for (int i = 0; i < GOBLIN_BAND; i++) {
+        g->hp[i][0] = GOBLIN_HP;
+        g->ap[i][0] = GOBLIN_AP;
+        g->str[i][0] = GOBLIN_STR;
+        g->dex[i][0] = GOBLIN_DEX;
+        g->mind[i][0] = GOBLIN_MIND;
+    }
+    xoshiro_t rng;
+    xoshiro_seed(&rng, xorshift(&rand_state));
+    battle_resolve(&battle, 1, &rng);
+
+    for (int i = 0; i < count; i++) {
+        hero_t *hero = fighters[i];
+        hero->ap = h->ap[i][0];
+        hero->hp = h->hp[i][0] > 0 ? h->hp[i][0] : 0;
+        if (!hero->hp) {
+            hero->active = false;
+            hero->squad = -1;
+            squad->member_count--;
+        }
+    }
+    if (!battle_standing(&battle, BATTLE_GOBLINS, 0))
+        invader_delete(game, game->invaders + squad->target);
+    else
+        squad->target = -1;
+}
+
+/**
+ * Heroes off the field, at the castle or in no squad, heal and rest.
+ */
+static void
+heroes_rest(game_t *game)
+{
+    for (unsigned i = 0; i < countof(game->heroes); i++) {
+        hero_t *hero = game->heroes + i;
+        if (!hero->active)
+            continue;
+        if (hero->squad >= 0) {
+            squad_t *squad = game->squads + hero->squad;
+            if ((int)squad->x != CASTLE_X(game->map) ||
+                (int)squad->y != CASTLE_Y(game->map))
+                continue;
+        }
+        hero->hp += HERO_REST_HP;
+        hero->hp = hero->hp < hero->hp_max ? hero->hp : hero->hp_max;
+        hero->ap += HERO_REST_AP;
+        hero->ap = hero->ap < hero->ap_max ? hero->ap : hero->ap_max;
+    }
+}
+
 void
 squad_step(game_t *game, squad_t *squad)
 {
     float tx, ty;
     if (squad->target < 0) {
-        tx = CASTLE_X;
-        ty = CASTLE_Y;
+        tx = CASTLE_X(game->map);
+        ty = CASTLE_Y(game->map);
     } else {
         invader_t *i = game->invaders + squad->target;
         if (!i->active) {
             squad->target = -1;
-            tx = CASTLE_X;
-            ty = CASTLE_Y;
+            tx = CASTLE_X(game->map);
+            ty = CASTLE_Y(game->map);
         }
         tx = i->x;
         ty = i->y;
@@ -452,8 +765,7 @@ squad_step(game_t *game, squad_t *squad)
         squad->y = ty;
         if (squad->target >= 0) {
             game_event_push(game, EVENT_BATTLE);
-            // TODO
-            invader_delete(game, game->invaders + squad->target);
+            squad_battle(game, squad);
         }
     } else {
         float speed = SQUAD_SPEED;
@@ -477,12 +789,23 @@ game_step(game_t *game)
         double food;
         double wood;
     } init = {game->gold, game->food, game->wood};
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-        for (int x = 0; x < MAP_WIDTH; x++) {
-            uint16_t building = game->map->high[x][y].building;
-            if (building != C_NONE) {
-                if (++game->map->high[x][y].building_age >= 0)
-                    building_process(game, building);
+    /* Buildings in row order, chunk by chunk, skipping empty squares
+     * eight at a time and chunks with none at all. */
+    map_t *map = game->map;
+    for (int c = 0; c < map->active_count; c++) {
+        map_chunk_t *chunk = map->chunk[map->active[c]];
+        const uint8_t *building = chunk->building[0];
+        int32_t *age = chunk->age[0];
+        int squares = chunk->rows * CHUNK_WIDTH;
+        for (int i = 0; i < squares; i += 8) {
+            uint64_t any;
+            memcpy(&any, building + i, sizeof(any));
+            for (int j = i; any && j < i + 8; j++) {
+                if (building[j] != C_NONE) {
+                    age[j] += age[j] < INT32_MAX;
+                    if (age[j] >= 0)
+                        building_process(game, building[j]);
+                }
             }
         }
     }
@@ -491,23 +814,36 @@ game_step(game_t *game)
         .food = (game->food - init.food) * DAY,
         .wood = (game->wood - init.wood) * DAY
     };
+    game_step_units(game);
+    return diff;
+}
 
+/**
+ * The rest of game_step() once buildings have yielded: units move,
+ * invaders spawn, events fire and the clock advances. Resources are
+ * neither read nor changed.
+ */
+void
+game_step_units(game_t *game)
+{
     for (unsigned i = 0; i < countof(game->squads); i++)
         if (game->squads[i].member_count > 0)
             squad_step(game, game->squads + i);
 
     if (rand_uniform(0, 1) < game->spawn_rate / DAY)
-        invader_push(game, invader_generate());
+        invader_push(game, invader_generate(game));
     for (unsigned i = 0; i < countof(game->invaders); i++)
         if (game->invaders[i].active)
             invader_step(game, game->invaders + i);
 
+    if (game->time % (long)HOUR == 0)
+        heroes_rest(game);
+
     /* Generate events. */
     if (game->population >= GAME_WIN_POP)
         game_event_push(game, EVENT_WIN);
 
     game->time++;
-    return diff;
 }
 
 yield_t
@@ -558,21 +894,26 @@ building_yield(uint16_t building)
     return (yield_t){0, 0, 0};
 }
 
+/**
+ * Draw GAME's units into P, with the square at X, Y in its top left
+ * corner, labelling invaders with their letters if ID.
+ */
 void
-game_draw_units(game_t *game, panel_t *p, bool id)
+game_draw_units(game_t *game, panel_t *p, int x, int y, bool id)
 {
     font_t land = FONT(R, k);
     font_t sea  = FONT(r, y);
     for (int i = 0; i < (int)countof(game->invaders); i++) {
         invader_t *inv = game->invaders + i;
         if (inv->active)
-            panel_putc(p, inv->x, inv->y, inv->embarked ? sea : land,
-                       id ? i + 'A' : inv->type);
+            panel_putc(p, (int)inv->x - x, (int)inv->y - y,
+                       inv->embarked ? sea : land, id ? i + 'A' : inv->type);
     }
     for (int i = 0; i < (int)countof(game->squads); i++) {
         squad_t *s = game->squads + i;
         if (s->member_count > 0 &&
-            !((int)s->x == CASTLE_X && (int)s->y == CASTLE_Y))
-            panel_putc(p, s->x, s->y, FONT(k, M), i + 'A');
+            !((int)s->x == CASTLE_X(game->map) &&
+              (int)s->y == CASTLE_Y(game->map)))
+            panel_putc(p, (int)s->x - x, (int)s->y - y, FONT(k, M), i + 'A');
     }
 }
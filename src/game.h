@@ -52,10 +52,20 @@ enum game_event {
 #define INVADER_VISION 10
 #define INVADER_RAMPAGE_END DAY
 
+/* Each invader is a band of goblins, all alike. */
+#define GOBLIN_BAND 3
+#define GOBLIN_HP   6
+#define GOBLIN_AP   15
+#define GOBLIN_STR  8
+#define GOBLIN_DEX  8
+#define GOBLIN_MIND 4
+
 #define SQUAD_SPEED 15
 #define MAX_HERO_INIT 4
 #define HERO_CANDIDATES 10
 #define HERO_INIT 2
+#define HERO_REST_HP 1 // regained each hour off the field
+#define HERO_REST_AP 5
 
 enum invader_type {
     I_GOBLIN = 'g'
@@ -103,15 +113,20 @@ typedef struct game {
     bool apology_given;
 } game_t;
 
-game_t *game_create(uint64_t map_seed);
+game_t *game_create(uint64_t map_seed, enum map_engine,
+                    int width, int height);
 bool    game_save(game_t *game, FILE *out);
 game_t *game_load(FILE *out);
+bool    game_peek_seed(FILE *in, uint64_t *seed, enum map_engine *);
 void    game_free(game_t *);
+uint64_t game_hash(game_t *);
 
+bool    game_can_afford(game_t *, yield_t cost);
 bool    game_build(game_t *, uint16_t building, int x, int y);
 yield_t game_step(game_t *);
+void    game_step_units(game_t *);
 void    game_date(game_t *, char *);
-void    game_draw_units(game_t *game, panel_t *p, bool id);
+void    game_draw_units(game_t *game, panel_t *p, int x, int y, bool id);
 
 hero_t  game_hero_generate(void);
 bool    game_hero_push(game_t *game, hero_t hero);
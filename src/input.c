@@ -0,0 +1,166 @@
+#include "input.h"
+#include "device.h"
+
+#define MASK (INPUT_RING - 1)
+#define SEQUENCE_MAX 16
+#define MALFORMED    -3 // decode() found bytes to discard, not a key
+
+void
+input_init(input_t *in)
+{
+    in->head = in->tail = 0;
+}
+
+size_t
+input_space(input_t *in, uint8_t **p)
+{
+    unsigned pos = in->tail & MASK;
+    size_t free = INPUT_RING - (in->tail - in->head);
+    size_t span = INPUT_RING - pos;
+    *p = in->ring + pos;
+    return free < span ? free : span;
+}
+
+void
+input_commit(input_t *in, size_t n)
+{
+    in->tail += n;
+}
+
+bool
+input_empty(input_t *in)
+{
+    return in->head == in->tail;
+}
+
+static inline int
+peek(input_t *in, unsigned i)
+{
+    return in->ring[(in->head + i) & MASK];
+}
+
+static int
+final_key(int param, int final)
+{
+    switch (final) {
+    case 'A':
+        return ARROW_U;
+    case 'B':
+        return ARROW_D;
+    case 'C':
+        return ARROW_R;
+    case 'D':
+        return ARROW_L;
+    case 'H':
+        return ARROW_UL;
+    case 'F':
+        return ARROW_DL;
+    case '~':
+        switch (param) {
+        case 1:
+        case 7:
+            return ARROW_UL;
+        case 4:
+        case 8:
+            return ARROW_DL;
+        case 5:
+            return ARROW_UR;
+        case 6:
+            return ARROW_DR;
+        }
+    }
+    return final + 256;
+}
+
+/**
+ * Decode the key at the head of the ring without consuming it. Its
+ * length in bytes is stored in LEN. A length with MALFORMED means the
+ * bytes should be discarded. NUL (Ctrl-@) is a key like any other.
+ */
+static int
+decode(input_t *in, unsigned *len, bool flush)
+{
+    unsigned n = in->tail - in->head;
+    if (n == 0)
+        return INPUT_NONE;
+    int c = peek(in, 0);
+    *len = 1;
+    if (c != '\e')
+        return c;
+    if (n == 1)
+        return flush ? c : INPUT_PARTIAL;
+    int intro = peek(in, 1);
+    if (intro != '[' && intro != 'O')
+        return c; // plain escape, the next byte stands alone
+    int param = 0;
+    bool first = true;
+    for (unsigned i = 2; i < n && i < SEQUENCE_MAX; i++) {
+        int b = peek(in, i);
+        if (b >= '0' && b <= '9') {
+            if (first)
+                param = param * 10 + b - '0';
+        } else if (b == ';') {
+            first = false; // modifiers are ignored
+        } else if (b >= 0x20 && b <= 0x3f) {
+            /* Other parameter and intermediate bytes */
+        } else if (b >= 0x40 && b <= 0x7e) {
+            *len = i + 1;
+            return final_key(param, b);
+        } else {
+            *len = i;
+            return MALFORMED;
+        }
+    }
+    if (n >= SEQUENCE_MAX) {
+        *len = SEQUENCE_MAX; // overlong, but what follows it stands
+        return MALFORMED;
+    }
+    return flush ? c : INPUT_PARTIAL;
+}
+
+/**
+ * Like input_next(), but the key is left queued.
+ */
+int
+input_peek(input_t *in)
+{
+    unsigned len;
+    int key;
+    while ((key = decode(in, &len, false)) == MALFORMED)
+        in->head += len;
+    return key;
+}
+
+/**
+ * Return the next key, INPUT_NONE, or INPUT_PARTIAL. With FLUSH, an
+ * incomplete sequence is given up on and its escape returned alone.
+ */
+int
+input_next(input_t *in, bool flush)
+{
+    for (;;) {
+        unsigned len;
+        int key = decode(in, &len, flush);
+        if (key == INPUT_NONE || key == INPUT_PARTIAL)
+            return key;
+        in->head += len;
+        if (key != MALFORMED)
+            return key;
+    }
+}
+
+/**
+ * Consume a run of queued arrow keys, accumulating their movement.
+ */
+bool
+input_motion(input_t *in, int *dx, int *dy)
+{
+    bool any = false;
+    unsigned len;
+    int key;
+    while ((key = decode(in, &len, false)) >= 0 && arrow_delta(key, dx, dy)) {
+        in->head += len;
+        any = true;
+    }
+    return any;
+}
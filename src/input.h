@@ -0,0 +1,29 @@
+/**
+ * Terminal input decoder. Raw bytes are queued into a ring buffer and
+ * decoded into keys, including CSI ("\e[") and SS3 ("\eO") sequences.
+ * Sequences may arrive split across any number of reads.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define INPUT_RING 256 // must be a power of two
+
+#define INPUT_NONE    -1 // no bytes queued
+#define INPUT_PARTIAL -2 // an incomplete escape sequence is queued
+
+typedef struct input {
+    unsigned head, tail;
+    uint8_t ring[INPUT_RING];
+} input_t;
+
+void   input_init(input_t *);
+size_t input_space(input_t *, uint8_t **);
+void   input_commit(input_t *, size_t);
+bool   input_empty(input_t *);
+
+int    input_peek(input_t *);
+int    input_next(input_t *, bool flush);
+bool   input_motion(input_t *, int *dx, int *dy);
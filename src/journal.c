@@ -0,0 +1,338 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "journal.h"
+
+#define JOURNAL_MAGIC "GCOMJNL7"
+#define NO_DEFAULT INT_MIN
+
+/* The answer a call gives when it has no entry */
+static const int defaults[] = {
+    [JOURNAL_GETCH]    = NO_DEFAULT,
+    [JOURNAL_KBHIT]    = 0,
+    [JOURNAL_TICK]     = 0,
+    [JOURNAL_MOTION]   = 0,
+    [JOURNAL_MOTION_X] = 0,
+    [JOURNAL_MOTION_Y] = 0,
+    [JOURNAL_RESIZED]  = 0,
+    [JOURNAL_WRITABLE] = 1,
+    [JOURNAL_WIDTH]    = NO_DEFAULT,
+    [JOURNAL_HEIGHT]   = NO_DEFAULT,
+    [JOURNAL_ENTROPY]  = NO_DEFAULT,
+    [JOURNAL_FILE]     = NO_DEFAULT,
+    [JOURNAL_CHECK]    = NO_DEFAULT,
+    [JOURNAL_READY]    = 0,
+    [JOURNAL_FRAMES]   = 1,
+    [JOURNAL_END]      = NO_DEFAULT,
+};
+
+struct journal {
+    FILE *file;
+    bool replaying;
+    bool over;     // replay finished or diverged
+    bool diverged;
+    uint64_t seq;  // device calls so far
+    uint64_t last; // call of the last entry written or read
+    unsigned checks;
+    void (*done)(journal_t *, bool closed);
+    struct {
+        bool valid;
+        uint64_t seq;
+        int call;
+        uint64_t value;
+        size_t len;
+        uint8_t *data;
+    } next; // the upcoming entry when replaying
+};
+
+static void
+varint_write(FILE *out, uint64_t v)
+{
+    for (; v >= 0x80; v >>= 7)
+        fputc(v | 0x80, out);
+    fputc(v, out);
+}
+
+static bool
+varint_read(FILE *in, uint64_t *v)
+{
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int b = fgetc(in);
+        if (b == EOF)
+            return false;
+        *v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static inline uint64_t
+zigzag(int64_t v)
+{
+    return (uint64_t)v << 1 ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t
+unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+journal_t *
+journal_create(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return NULL;
+    fwrite(JOURNAL_MAGIC, 8, 1, file);
+    journal_t *j = calloc(sizeof(*j), 1);
+    j->file = file;
+    return j;
+}
+
+/**
+ * Read the next entry into the lookahead.
+ */
+static void
+journal_advance(journal_t *j)
+{
+    uint64_t delta;
+    int call;
+    j->next.valid = false;
+    if (!varint_read(j->file, &delta) || (call = fgetc(j->file)) == EOF)
+        return;
+    j->next.seq = j->last += delta;
+    j->next.call = call;
+    j->next.len = 0;
+    switch (call) {
+    case JOURNAL_ENTROPY:
+    case JOURNAL_FILE:
+        if (!varint_read(j->file, &j->next.value))
+            return;
+        j->next.len = j->next.value;
+        j->next.data = realloc(j->next.data, j->next.len + 1);
+        if (j->next.len && !fread(j->next.data, j->next.len, 1, j->file))
+            return;
+        break;
+    case JOURNAL_END:
+        break;
+    default:
+        if (call > JOURNAL_END || !varint_read(j->file, &j->next.value))
+            return;
+    }
+    j->next.valid = true;
+}
+
+/**
+ * Replay a journal. DONE is called once the replay is over: the
+ * recording has ended, diverged from the game, or was closed. CLOSED
+ * tells the last apart, where the game has finished with the journal
+ * rather than still asking it for answers.
+ */
+journal_t *
+journal_open(const char *path, void (*done)(journal_t *, bool closed))
+{
+    FILE *file = fopen(path, "rb");
+    char magic[8];
+    if (!file)
+        return NULL;
+    if (!fread(magic, sizeof(magic), 1, file) ||
+        memcmp(magic, JOURNAL_MAGIC, 8)) {
+        fclose(file);
+        return NULL;
+    }
+    journal_t *j = calloc(sizeof(*j), 1);
+    j->file = file;
+    j->replaying = true;
+    j->done = done;
+    journal_advance(j);
+    return j;
+}
+
+static void
+journal_finish(journal_t *j, bool diverged, bool closed)
+{
+    if (!j->over) {
+        j->over = true;
+        j->diverged = diverged;
+        if (j->done)
+            j->done(j, closed);
+    }
+}
+
+void
+journal_close(journal_t *j)
+{
+    if (!j)
+        return;
+    if (j->replaying) {
+        journal_finish(j, false, true);
+    } else {
+        varint_write(j->file, j->seq - j->last);
+        fputc(JOURNAL_END, j->file);
+    }
+    fclose(j->file);
+    free(j->next.data);
+    free(j);
+}
+
+bool
+journal_replaying(journal_t *j)
+{
+    return j && j->replaying;
+}
+
+/**
+ * Start a call. When recording, returns true if it must be logged.
+ * When replaying, returns true if the upcoming entry answers it.
+ */
+static bool
+journal_begin(journal_t *j, enum journal_call call, bool usual)
+{
+    if (!j->replaying) {
+        if (usual)
+            return false;
+        varint_write(j->file, j->seq - j->last);
+        fputc(call, j->file);
+        j->last = j->seq;
+        return true;
+    }
+    if (j->over)
+        return false;
+    if (!j->next.valid ||
+        (j->next.call == JOURNAL_END && j->next.seq == j->seq)) {
+        journal_finish(j, false, false); // past the end of the recording
+    } else if (j->next.seq == j->seq) {
+        if (j->next.call == (int)call)
+            return true;
+        journal_finish(j, true, false);
+    } else if (defaults[call] == NO_DEFAULT) {
+        journal_finish(j, true, false);
+    }
+    return false;
+}
+
+/**
+ * Log a device call that answered VALUE, or when replaying, return
+ * the answer it gave in the recording.
+ */
+int
+journal_int(journal_t *j, enum journal_call call, int value)
+{
+    if (!j)
+        return value;
+    if (journal_begin(j, call, value == defaults[call])) {
+        if (j->replaying) {
+            value = unzigzag(j->next.value);
+            journal_advance(j);
+        } else {
+            varint_write(j->file, zigzag(value));
+        }
+    } else if (j->replaying) {
+        value = defaults[call] == NO_DEFAULT ? 0 : defaults[call];
+    }
+    j->seq++;
+    return value;
+}
+
+void
+journal_bytes(journal_t *j, enum journal_call call, void *buf, size_t len)
+{
+    if (!j)
+        return;
+    if (journal_begin(j, call, false)) {
+        if (!j->replaying) {
+            varint_write(j->file, len);
+            fwrite(buf, len, 1, j->file);
+        } else if (j->next.len == len) {
+            memcpy(buf, j->next.data, len);
+            journal_advance(j);
+        } else {
+            journal_finish(j, true, false);
+        }
+    }
+    j->seq++;
+}
+
+/**
+ * Log the contents of a file the game is about to read, returning it
+ * rewound. When replaying, returns a copy of the logged file, or NULL
+ * if there was none.
+ */
+FILE *
+journal_file(journal_t *j, FILE *f)
+{
+    if (!j)
+        return f;
+    uint8_t *data = NULL;
+    size_t len = 0;
+    if (!j->replaying && f) {
+        size_t cap = 0, n;
+        do {
+            if (len == cap) {
+                cap = cap ? cap * 2 : 4096;
+                data = realloc(data, cap);
+            }
+            len += n = fread(data + len, 1, cap - len, f);
+        } while (n);
+        rewind(f);
+    }
+    if (journal_begin(j, JOURNAL_FILE, false)) {
+        if (!j->replaying) {
+            varint_write(j->file, len);
+            fwrite(data, len, 1, j->file);
+        } else {
+            f = NULL;
+            if (j->next.len && (f = tmpfile())) {
+                fwrite(j->next.data, j->next.len, 1, f);
+                rewind(f);
+            }
+            journal_advance(j);
+        }
+    }
+    free(data);
+    j->seq++;
+    return f;
+}
+
+/**
+ * Log a hash of the game state, or when replaying, verify it.
+ */
+void
+journal_check(journal_t *j, uint64_t hash)
+{
+    if (!j)
+        return;
+    if (journal_begin(j, JOURNAL_CHECK, false)) {
+        if (!j->replaying) {
+            varint_write(j->file, hash);
+            fflush(j->file); // a crash loses at most one interval
+        } else if (j->next.value == hash) {
+            j->checks++;
+            journal_advance(j);
+        } else {
+            journal_finish(j, true, false);
+        }
+    }
+    j->seq++;
+}
+
+uint64_t
+journal_calls(journal_t *j)
+{
+    return j->seq;
+}
+
+unsigned
+journal_checks(journal_t *j)
+{
+    return j->checks;
+}
+
+bool
+journal_diverged(journal_t *j)
+{
+    return j->diverged;
+}
@@ -0,0 +1,57 @@
+/**
+ * Input journals. Everything a game learns from outside (its random
+ * seed, a resumed save, keystrokes, frame ticks and the time they
+ * cover, window changes)
+ * comes through the device, which logs it to the attached journal.
+ * The game logs the one thing that does not: when a world being
+ * generated in the background turns out to be ready. A
+ * replayed journal answers those same calls instead, so a headless
+ * device drives the game through exactly the same states as fast as
+ * it can run. Periodic state checks catch any divergence.
+ *
+ * Entries are keyed by their position in the stream of device calls,
+ * which the main loop advances once per frame tick. Calls returning
+ * their usual answer (no key, no resize) are not logged at all.
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+enum journal_call {
+    JOURNAL_GETCH,
+    JOURNAL_KBHIT,
+    JOURNAL_TICK,
+    JOURNAL_MOTION,
+    JOURNAL_MOTION_X,
+    JOURNAL_MOTION_Y,
+    JOURNAL_RESIZED,
+    JOURNAL_WRITABLE,
+    JOURNAL_WIDTH,
+    JOURNAL_HEIGHT,
+    JOURNAL_ENTROPY,
+    JOURNAL_FILE,
+    JOURNAL_CHECK,
+    JOURNAL_READY,
+    JOURNAL_FRAMES,
+    JOURNAL_END,
+};
+
+typedef struct journal journal_t;
+
+journal_t *journal_create(const char *path);
+journal_t *journal_open(const char *path,
+                        void (*done)(journal_t *, bool closed));
+void       journal_close(journal_t *);
+
+bool     journal_replaying(journal_t *);
+int      journal_int(journal_t *, enum journal_call, int value);
+void     journal_bytes(journal_t *, enum journal_call, void *, size_t);
+FILE    *journal_file(journal_t *, FILE *);
+void     journal_check(journal_t *, uint64_t hash);
+
+uint64_t journal_calls(journal_t *);
+unsigned journal_checks(journal_t *);
+bool     journal_diverged(journal_t *);
@@ -0,0 +1,184 @@
+/**
+ * Loopback load generator for gcom --serve. Opens many telnet sessions
+ * that negotiate like a real client and press keys like a slow player,
+ * then reports server CPU time and memory per session.
+ *
+ *   loadgen PORT SESSIONS SECONDS SERVER_PID
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define IAC  255
+#define WILL 251
+#define DO   253
+#define SB   250
+#define SE   240
+
+typedef struct {
+    int fd;
+    size_t received;
+    size_t key;
+} client_t;
+
+static const char *keys[] = {"\r", "h", "q", "s", "q", "p", "\e[B", "q", ".", ","};
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Server CPU seconds and resident kB. */
+static void
+sample(int pid, double *cpu, long *rss)
+{
+    char path[64], line[256];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE *f = fopen(path, "r");
+    unsigned long utime = 0, stime = 0;
+    if (f) {
+        if (fscanf(f, "%*d %*s %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u"
+                   " %lu %lu", &utime, &stime) != 2)
+            utime = stime = 0;
+        fclose(f);
+    }
+    *cpu = (utime + stime) / (double)sysconf(_SC_CLK_TCK);
+    snprintf(path, sizeof(path), "/proc/%d/status", pid);
+    *rss = 0;
+    if ((f = fopen(path, "r"))) {
+        while (fgets(line, sizeof(line), f))
+            if (sscanf(line, "VmRSS: %ld", rss) == 1)
+                break;
+        fclose(f);
+    }
+}
+
+static void
+negotiate(client_t *c, const unsigned char *p, size_t len)
+{
+    for (size_t i = 0; i + 2 < len; i++) {
+        if (p[i] != IAC)
+            continue;
+        if (p[i + 1] == DO && p[i + 2] == 31) {
+            unsigned char naws[] = {IAC, WILL, 31, IAC, SB, 31, 0, 80, 0, 24,
+                                    IAC, SE};
+            write(c->fd, naws, sizeof(naws));
+        } else if (p[i + 1] == DO && p[i + 2] == 24) {
+            unsigned char ttype[] = {IAC, WILL, 24};
+            write(c->fd, ttype, sizeof(ttype));
+        } else if (p[i + 1] == SB && p[i + 2] == 24) {
+            unsigned char is[] = {IAC, SB, 24, 0, 'x', 't', 'e', 'r', 'm',
+                                  IAC, SE};
+            write(c->fd, is, sizeof(is));
+        }
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    if (argc != 5) {
+        fprintf(stderr, "usage: %s PORT SESSIONS SECONDS SERVER_PID\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    int port = atoi(argv[1]);
+    int n = atoi(argv[2]);
+    double seconds = atof(argv[3]);
+    int pid = atoi(argv[4]);
+
+    double cpu0, cpu1 = 0;
+    long rss0, rss1 = 0;
+    sample(pid, &cpu0, &rss0);
+    (void) cpu0;
+    (void) rss1;
+
+    client_t *clients = calloc(n, sizeof(*clients));
+    struct pollfd *fds = calloc(n, sizeof(*fds));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+    };
+    for (int i = 0; i < n; i++) {
+        clients[i].fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(clients[i].fd, (void *)&addr, sizeof(addr)) < 0) {
+            perror("connect");
+            return EXIT_FAILURE;
+        }
+        fds[i] = (struct pollfd){clients[i].fd, POLLIN, 0};
+    }
+
+    /* Wait for every session to draw its first frame. */
+    double start = now();
+    int ready = 0;
+    double measure = 0, next_key = 0;
+    size_t measured = 0;
+    int sampled = 0;
+    for (;;) {
+        double t = now();
+        if (!measure && ready == n) {
+            measure = t + 1.0; // let world generation settle
+            next_key = measure;
+        }
+        if (measure && t >= measure && !sampled) {
+            sample(pid, &cpu1, &rss1);
+            for (int i = 0; i < n; i++)
+                measured += clients[i].received;
+            sampled = 1;
+        }
+        if (measure && t >= measure + seconds)
+            break;
+        if (next_key && t >= next_key) {
+            for (int i = 0; i < n; i++) {
+                client_t *c = clients + i;
+                const char *k = keys[c->key++ % (sizeof(keys) / sizeof(*keys))];
+                write(c->fd, k, strlen(k));
+            }
+            next_key += 0.5;
+        }
+        if (poll(fds, n, 20) < 0)
+            break;
+        for (int i = 0; i < n; i++) {
+            if (!(fds[i].revents & POLLIN))
+                continue;
+            unsigned char buf[65536];
+            ssize_t r = read(fds[i].fd, buf, sizeof(buf));
+            if (r <= 0) {
+                fprintf(stderr, "session %d closed\n", i);
+                return EXIT_FAILURE;
+            }
+            negotiate(clients + i, buf, r);
+            if (clients[i].received < 1024 && clients[i].received + r >= 1024)
+                ready++; // past negotiation and into the first frame
+            clients[i].received += r;
+        }
+    }
+
+    double cpu2;
+    long rss2;
+    sample(pid, &cpu2, &rss2);
+    size_t total = 0;
+    for (int i = 0; i < n; i++)
+        total += clients[i].received;
+    double cpu = cpu2 - cpu1;
+    printf("sessions:            %d\n", n);
+    printf("startup:             %.2f s\n", measure - 1.0 - start);
+    printf("server CPU:          %.1f%% of one core\n", 100 * cpu / seconds);
+    printf("sessions per core:   %.0f\n", cpu > 0 ? n * seconds / cpu : 0.0);
+    printf("memory per session:  %.1f MB\n", (rss2 - rss0) / 1024.0 / n);
+    printf("output per session:  %.1f kB/s\n",
+           (total - measured) / 1024.0 / seconds / n);
+    return 0;
+}
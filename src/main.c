@@ -6,17 +6,34 @@
 #include <ctype.h>
 #include <assert.h>
 #include <unistd.h>
+#include <inttypes.h>
+#include <setjmp.h>
+#include <sys/stat.h>
 #include "display.h"
+#include "record.h"
+#include "journal.h"
+#include "rewind.h"
+#include "bot.h"
 #include "rand.h"
 #include "map.h"
 #include "game.h"
 #include "utf.h"
+#ifndef _WIN32
+#include "server.h"
+#include "broadcast.h"
+#endif
 
 #define FPS 15
 #define PERIOD (1000000 / FPS)
 #define SPEED_MAX 7776
 #define SPEED_FACTOR 6
 #define PERSIST_FILE "persist.gcom"
+#define RECORD_FILE "session.gcr" // the last local game is recorded here
+#define JOURNAL_FILE "session.gcj" // and journaled here
+#define SESSION_DIR "sessions"    // each served game goes in here
+#define CHECK_INTERVAL 64 // frames between journal state checks
+#define VIEW_MARGIN_X 8 // squares kept between the cursor and the edge
+#define VIEW_MARGIN_Y 4
 
 static const font_t font_error = FONT_STATIC(Y, k);
 
@@ -26,14 +43,85 @@ is_exit_key(int key)
     return key == 'Q' || key == 'q' || key == 27;
 }
 
+/* World square at the top left of the map panels, per session. */
+static __thread int view_x, view_y;
+
+/**
+ * Keep the view inside GAME's world.
+ */
+static void
+view_clamp(game_t *game)
+{
+    int max_x = game->map->width - MAP_WIDTH;
+    int max_y = game->map->height - MAP_HEIGHT;
+    view_x = view_x < 0 ? 0 : view_x > max_x ? max_x : view_x;
+    view_y = view_y < 0 ? 0 : view_y > max_y ? max_y : view_y;
+}
+
+/**
+ * Scroll the view, if need be, so that X, Y is not near its edges.
+ * Returns true if it moved.
+ */
+static bool
+view_follow(game_t *game, int x, int y)
+{
+    int old_x = view_x, old_y = view_y;
+    int mx = VIEW_MARGIN_X, my = VIEW_MARGIN_Y;
+    if (x < view_x + mx)
+        view_x = x - mx;
+    else if (x >= view_x + MAP_WIDTH - mx)
+        view_x = x - MAP_WIDTH + mx + 1;
+    if (y < view_y + my)
+        view_y = y - my;
+    else if (y >= view_y + MAP_HEIGHT - my)
+        view_y = y - MAP_HEIGHT + my + 1;
+    view_clamp(game);
+    return view_x != old_x || view_y != old_y;
+}
+
+/**
+ * Draw the part of GAME in view into its map panels.
+ */
+static void
+view_draw(game_t *game, panel_t *terrain, panel_t *buildings, panel_t *units)
+{
+    map_draw_terrain(game->map, terrain, view_x, view_y);
+    panel_clear(buildings);
+    map_draw_buildings(game->map, buildings, view_x, view_y);
+    panel_clear(units);
+    game_draw_units(game, units, view_x, view_y, false);
+}
+
+/**
+ * Start generating the world for SEED and ENGINE in the background.
+ * A server session gives it up if its client drops first.
+ */
+static void
+world_prefetch(uint64_t seed, enum map_engine engine)
+{
+    map_prefetch(seed, engine);
+#ifndef _WIN32
+    server_session_world(seed, engine, true);
+#endif
+}
+
+static void
+world_discard(uint64_t seed, enum map_engine engine)
+{
+    map_discard(seed, engine);
+#ifndef _WIN32
+    server_session_world(seed, engine, false);
+#endif
+}
+
 static int
 game_getch(game_t *game, panel_t *terrain)
 {
     for (;;) {
-        map_draw_terrain(game->map, terrain);
+        if (game)
+            map_draw_terrain(game->map, terrain, view_x, view_y);
         display_refresh();
-        uint64_t wait = device_uepoch() % PERIOD;
-        if (device_kbhit(wait))
+        if (device_tick(PERIOD))
             return device_getch();
     }
 }
@@ -65,20 +153,14 @@ popup_message(font_t font, char *format, ...)
 }
 
 static bool
-popup_quit(bool saving)
+popup_confirm(char *message)
 {
     panel_t popup;
-    char *message;
-    if (saving)
-        message = "Really save and quit? (Rk{y}/Rk{n})";
-    else
-        message = "Really quit Yk{without saving}? (Rk{y}/Rk{n})";
-    size_t length = strlen(message) - 8;
+    size_t length = panel_strlen(message);
     panel_center_init(&popup, length + 2, 3);
     panel_printf(&popup, 1, 1, message);
     display_push(&popup);
-    display_refresh();
-    int input = device_getch();
+    int input = display_getch();
     display_pop_free();
     display_refresh();
     if (input == 'y' || input == 'Y')
@@ -86,6 +168,15 @@ popup_quit(bool saving)
     return false;
 }
 
+static bool
+popup_quit(bool saving)
+{
+    if (saving)
+        return popup_confirm("Really save and quit? (Rk{y}/Rk{n})");
+    else
+        return popup_confirm("Really quit Yk{without saving}? (Rk{y}/Rk{n})");
+}
+
 #define SIDEMENU_WIDTH (DISPLAY_WIDTH - MAP_WIDTH)
 
 static int
@@ -110,25 +201,28 @@ sidemenu_draw(panel_t *p, game_t *game, yield_t diff)
     panel_border(p, font_title);
     panel_puts(p, 5, 1, font_title, "Goblin-COM");
 
+    static template_t gold = TEMPLATE("Gold: Yk{%ld}wk{%+d}");
+    static template_t food = TEMPLATE("Food: Yk{%ld}wk{%+d}");
+    static template_t wood = TEMPLATE("Wood: Yk{%ld}wk{%+d}");
+    static template_t pop = TEMPLATE("Pop.: %ld");
     font_t font_totals = FONT(W, k);
     int ty = 3;
-    panel_printf(p, 2, ty++, "Gold: Yk{%ld}wk{%+d}",
-                 (long)game->gold, (int)diff.gold);
-    panel_printf(p, 2, ty++, "Food: Yk{%ld}wk{%+d}",
-                 (long)game->food, (int)diff.food);
-    panel_printf(p, 2, ty++, "Wood: Yk{%ld}wk{%+d}",
-                 (long)game->wood, (int)diff.wood);
-    panel_printf(p, 2, ty++, "Pop.: %ld", (long)game->population);
-
-    int x = 2;
-    int y = 8;
-    panel_printf(p, x, y++, "Kk{♦}    wk{Rk{B}uild}     Kk{♦}");
-    panel_printf(p, x, y++, "Kk{♦}    wk{Rk{H}eroes}    Kk{♦}");
-    panel_printf(p, x, y++, "Kk{♦}    wk{Rk{S}quads}    Kk{♦}");
-
-    y = 17;
-    panel_printf(p, x, y++, "Kk{♦}    wk{SRk{t}ory}     Kk{♦}");
-    panel_printf(p, x, y++, "Kk{♦}     wk{HelRk{p}}     Kk{♦}");
+    panel_template(p, 2, ty++, &gold, (long)game->gold, (int)diff.gold);
+    panel_template(p, 2, ty++, &food, (long)game->food, (int)diff.food);
+    panel_template(p, 2, ty++, &wood, (long)game->wood, (int)diff.wood);
+    panel_template(p, 2, ty++, &pop, (long)game->population);
+
+    static template_t menu[] = {
+        TEMPLATE("Kk{♦}    wk{Rk{B}uild}     Kk{♦}"),
+        TEMPLATE("Kk{♦}    wk{Rk{H}eroes}    Kk{♦}"),
+        TEMPLATE("Kk{♦}    wk{Rk{S}quads}    Kk{♦}"),
+        TEMPLATE("Kk{♦}    wk{Rk{R}ewind}    Kk{♦}"),
+        TEMPLATE("Kk{♦}    wk{SRk{t}ory}     Kk{♦}"),
+        TEMPLATE("Kk{♦}     wk{HelRk{p}}     Kk{♦}"),
+    };
+    static const int menu_y[] = {8, 9, 10, 12, 17, 18};
+    for (unsigned i = 0; i < countof(menu); i++)
+        panel_template(p, 2, menu_y[i], menu + i);
 
     char date[128];
     game_date(game, date);
@@ -144,8 +238,8 @@ sidemenu_draw(panel_t *p, game_t *game, yield_t diff)
 static inline char *
 u8encode(uint16_t c)
 {
-    static int i = 0;
-    static char buf[8][7];
+    static __thread int i = 0;
+    static __thread char buf[8][7];
     buf[i][utf32_to_8(c, (uint8_t *)buf[i % 8])] = '\0';
     return buf[i++ % 8];
 }
@@ -166,53 +260,65 @@ popup_build_select(game_t *game, panel_t *terrain)
     char cost[128];
     char yield[128];
 
+    static template_t
+        lumberyard = TEMPLATE("(Rk{w}) Yk{Lumberyard} [%s]"),
+        farm = TEMPLATE("(Rk{f}) Yk{Farm} [%s]"),
+        stable = TEMPLATE("(Rk{s}) Yk{Stable} [%s]"),
+        mine = TEMPLATE("(Rk{m}) Yk{Mine} [%s]"),
+        hamlet = TEMPLATE("(Rk{h}) Yk{Hamlet} [%s]"),
+        road = TEMPLATE("(Rk{r}) Yk{Road} [%s]"),
+        yields = TEMPLATE("wk{Yield: %s}"),
+        yields_heroes = TEMPLATE("wk{Yield: %s}, gk{adds %d hero slots}"),
+        yields_pop = TEMPLATE("wk{Yield: %s}, gk{adds %d pop.}"),
+        yields_road = TEMPLATE("wk{Yield: %s}, "
+                               "gk{removes movement penalties}"),
+        target1 = TEMPLATE("wk{Target: %s (%s)}"),
+        target2 = TEMPLATE("wk{Target: %s (%s), %s (%s)}"),
+        target3 = TEMPLATE("wk{Target: %s (%s), %s (%s), %s (%s)}"),
+        target_any = TEMPLATE("wk{Target: (any land)}");
+
     int y = 1;
     yield_string(cost, COST_LUMBERYARD, false);
     yield_string(yield, YIELD_LUMBERYARD, true);
-    panel_printf(p,   1, y++, "(Rk{w}) Yk{Lumberyard} [%s]", cost);
-    panel_printf(p, 5, y++, "wk{Yield: %s}", yield);
-    panel_printf(p, 5, y++, "wk{Target: forest (%s)}",
-                 u8encode(BASE_FOREST));
+    panel_template(p, 1, y++, &lumberyard, cost);
+    panel_template(p, 5, y++, &yields, yield);
+    panel_template(p, 5, y++, &target1, "forest", u8encode(BASE_FOREST));
 
     yield_string(cost, COST_FARM, false);
     yield_string(yield, YIELD_FARM, true);
-    panel_printf(p, 1, y++, "(Rk{f}) Yk{Farm} [%s]", cost);
-    panel_printf(p, 5, y++, "wk{Yield: %s}", yield);
-    panel_printf(p, 5, y++, "wk{Target: grassland (%s), forest (%s)}",
-                 u8encode(BASE_GRASSLAND), u8encode(BASE_FOREST));
+    panel_template(p, 1, y++, &farm, cost);
+    panel_template(p, 5, y++, &yields, yield);
+    panel_template(p, 5, y++, &target2,
+                   "grassland", u8encode(BASE_GRASSLAND),
+                   "forest", u8encode(BASE_FOREST));
 
     yield_string(cost, COST_STABLE, false);
     yield_string(yield, YIELD_STABLE, true);
-    panel_printf(p, 1, y++, "(Rk{s}) Yk{Stable} [%s]", cost);
-    panel_printf(p, 5, y++, "wk{Yield: %s}, gk{adds %d hero slots}",
-                 yield, STABLE_INC);
-    panel_printf(p, 5, y++, "wk{Target: grassland (%s)}",
-                 u8encode(BASE_GRASSLAND));
+    panel_template(p, 1, y++, &stable, cost);
+    panel_template(p, 5, y++, &yields_heroes, yield, STABLE_INC);
+    panel_template(p, 5, y++, &target1,
+                   "grassland", u8encode(BASE_GRASSLAND));
 
     yield_string(cost, COST_MINE, false);
     yield_string(yield, YIELD_MINE, true);
-    panel_printf(p, 1, y++, "(Rk{m}) Yk{Mine} [%s]", cost);
-    panel_printf(p, 5, y++, "wk{Yield: %s}", yield);
-    panel_printf(p, 5, y++, "wk{Target: hill (%s)}",
-                 u8encode(BASE_HILL));
+    panel_template(p, 1, y++, &mine, cost);
+    panel_template(p, 5, y++, &yields, yield);
+    panel_template(p, 5, y++, &target1, "hill", u8encode(BASE_HILL));
 
     yield_string(cost, COST_HAMLET, false);
     yield_string(yield, YIELD_HAMLET, true);
-    panel_printf(p, 1, y++, "(Rk{h}) Yk{Hamlet} [%s]", cost);
-    panel_printf(p, 5, y++, "wk{Yield: %s}, gk{adds %d pop.}", yield,
-                 HAMLET_INC);
-    panel_printf(p, 5, y++,
-                 "wk{Target: grassland (%s), forest (%s), hill (%s)}",
-                 u8encode(BASE_GRASSLAND),
-                 u8encode(BASE_FOREST),
-                 u8encode(BASE_HILL));
+    panel_template(p, 1, y++, &hamlet, cost);
+    panel_template(p, 5, y++, &yields_pop, yield, HAMLET_INC);
+    panel_template(p, 5, y++, &target3,
+                   "grassland", u8encode(BASE_GRASSLAND),
+                   "forest", u8encode(BASE_FOREST),
+                   "hill", u8encode(BASE_HILL));
 
     yield_string(cost, COST_ROAD, false);
     yield_string(yield, YIELD_ROAD, true);
-    panel_printf(p, 1, y++, "(Rk{r}) Yk{Road} [%s]", cost);
-    panel_printf(p, 5, y++, "wk{Yield: %s}, "
-                 "gk{removes movement penalties}", yield);
-    panel_printf(p, 5, y++, "wk{Target: (any land)}");
+    panel_template(p, 1, y++, &road, cost);
+    panel_template(p, 5, y++, &yields_road, yield);
+    panel_template(p, 5, y++, &target_any);
 
     while (result == 0 && !is_exit_key(input = game_getch(game, terrain)))
         if (strchr("wfshmr", input))
@@ -223,44 +329,13 @@ popup_build_select(game_t *game, panel_t *terrain)
     return result;
 }
 
+/**
+ * Move a cursor around GAME's world from *X, *Y, scrolling the map
+ * panels along with it. Returns true if a square was picked.
+ */
 static bool
-arrow_adjust(int input, int *x, int *y)
-{
-    switch (input) {
-    case ARROW_U:
-        (*y)--;
-        return true;
-    case ARROW_D:
-        (*y)++;
-        return true;
-    case ARROW_L:
-        (*x)--;
-        return true;
-    case ARROW_R:
-        (*x)++;
-        return true;
-    case ARROW_UL:
-        (*x)--;
-        (*y)--;
-        return true;
-    case ARROW_UR:
-        (*x)++;
-        (*y)--;
-        return true;
-    case ARROW_DL:
-        (*x)--;
-        (*y)++;
-        return true;
-    case ARROW_DR:
-        (*x)++;
-        (*y)++;
-        return true;
-    }
-    return false;
-}
-
-static bool
-select_position(game_t *game, panel_t *world, int *x, int *y)
+select_position(game_t *game, panel_t *world, panel_t *buildings,
+                panel_t *units, int *x, int *y)
 {
     panel_t info;
     int sidey = sideinfo(&info, "Yk{Select Location}");
@@ -270,13 +345,23 @@ select_position(game_t *game, panel_t *world, int *x, int *y)
     bool selected = false;
     panel_t overlay;
     panel_init(&overlay, 0, 0, MAP_WIDTH, MAP_HEIGHT);
-    panel_putc(&overlay, *x, *y, highlight, panel_getc(world, *x, *y));
+    if (view_follow(game, *x, *y))
+        view_draw(game, world, buildings, units);
+    int cx = *x - view_x, cy = *y - view_y;
+    panel_putc(&overlay, cx, cy, highlight, panel_getc(world, cx, cy));
     display_push(&overlay);
     int input;
     while (!selected && !is_exit_key(input = game_getch(game, world))) {
-        panel_erase(&overlay, *x, *y);
-        arrow_adjust(input, x, y);
-        panel_putc(&overlay, *x, *y, highlight, panel_getc(world, *x, *y));
+        panel_erase(&overlay, *x - view_x, *y - view_y);
+        if (arrow_delta(input, x, y))
+            device_motion(x, y); // coalesce auto-repeat into one move
+        *x = *x < 0 ? 0 : *x >= game->map->width ? game->map->width - 1 : *x;
+        *y = *y < 0 ? 0 : *y >= game->map->height ? game->map->height - 1 : *y;
+        if (view_follow(game, *x, *y))
+            view_draw(game, world, buildings, units);
+        cx = *x - view_x;
+        cy = *y - view_y;
+        panel_putc(&overlay, cx, cy, highlight, panel_getc(world, cx, cy));
         if (input == 13)
             selected = true;
     }
@@ -286,15 +371,6 @@ select_position(game_t *game, panel_t *world, int *x, int *y)
     return selected;
 }
 
-static bool
-can_afford(game_t *game, yield_t yield)
-{
-    return
-        (yield.food == 0 || game->food >= yield.food) &&
-        (yield.wood == 0 || game->wood >= yield.wood) &&
-        (yield.gold == 0 || game->gold >= yield.gold);
-}
-
 static bool
 persist(game_t *game)
 {
@@ -306,7 +382,7 @@ persist(game_t *game)
     return false;
 }
 
-static game_t *atexit_save_game;
+static __thread game_t *atexit_save_game; // only the main thread's counts
 static void
 atexit_save(void)
 {
@@ -315,17 +391,17 @@ atexit_save(void)
 }
 
 static void
-ui_build(game_t *game, panel_t *terrain)
+ui_build(game_t *game, panel_t *terrain, panel_t *buildings, panel_t *units)
 {
     uint16_t building;
     while ((building = popup_build_select(game, terrain))) {
         yield_t cost = building_cost(building);
-        if (!can_afford(game, cost)) {
+        if (!game_can_afford(game, cost)) {
             popup_message(font_error, "Not enough funding/materials!");
         } else {
-            int x = MAP_WIDTH / 2;
-            int y = MAP_HEIGHT / 2;
-            while (select_position(game, terrain, &x, &y)) {
+            int x = view_x + MAP_WIDTH / 2;
+            int y = view_y + MAP_HEIGHT / 2;
+            while (select_position(game, terrain, buildings, units, &x, &y)) {
                 if (!game_build(game, building, x, y))
                     popup_message(font_error, "Invalid building location!");
                 else
@@ -350,7 +426,7 @@ select_target(game_t *game, panel_t *terrain, panel_t *units)
             result = key - 'a';
             break;
         }
-        game_draw_units(game, units, true);
+        game_draw_units(game, units, view_x, view_y, true);
     } while (!is_exit_key(key = game_getch(game, terrain)));
 
     display_pop_free();
@@ -430,6 +506,9 @@ ui_heroes(game_t *game, panel_t *terrain)
     panel_center_init(&p, w, h);
     display_push(&p);
 
+    static template_t header =
+        TEMPLATE("wk{Name             Squad   HP   AP  STR  DEX MIND}");
+    static template_t pager = TEMPLATE("Rk{<} wk{Page %d} Rk{>}");
     int per_page = h - 3;
     int total = countof(game->heroes);
     int page_max = total / per_page;
@@ -439,8 +518,7 @@ ui_heroes(game_t *game, panel_t *terrain)
     do {
         panel_fill(&p, FONT_DEFAULT, ' ');
         panel_border(&p, FONT(w, k));
-        panel_printf(&p, 1, 1,
-                     "wk{Name             Squad   HP   AP  STR  DEX MIND}");
+        panel_template(&p, 1, 1, &header);
         switch (key) {
         case ARROW_U:
             if (selection > 0)
@@ -483,7 +561,7 @@ ui_heroes(game_t *game, panel_t *terrain)
                 ui_hire(game, terrain, selection);
         }break;
         }
-        panel_printf(&p, 1, h - 1, "Rk{<} wk{Page %d} Rk{>}", page + 1);
+        panel_template(&p, 1, h - 1, &pager, page + 1);
         for (int i = 0; i < per_page; i++) {
             int si = page * per_page + i;
             if (si > total)
@@ -508,93 +586,48 @@ ui_heroes(game_t *game, panel_t *terrain)
             }
             panel_printf(&p, 1, i + 2, format,
                          h->name, h->squad < 0 ? ' ' : h->squad + 'A',
-                         h->hp_max, h->ap_max,
+                         h->hp, h->ap,
                          h->str, h->dex, h->mind);
         }
     } while (!is_exit_key(key = game_getch(game, terrain)));
     display_pop_free();
 }
 
-static inline const char *
-text_next_line(const char *p)
-{
-    for (; *p != '\n'; p++);
-    return p + 1;
-}
-
-static inline const char *
-text_prev_line(const char *p)
-{
-    p -= 2;
-    for (; *p != '\n'; p--);
-    return p + 1;
-}
-
-static inline int
-text_numlines(const char *p)
-{
-    int count = 0;
-    for (; *p != '@'; p = text_next_line(p))
-        count++;
-    return count;
-}
-
-static inline int
-text_linelen(const char *p)
-{
-    int count = 0;
-    for (; *p != '\n'; p++)
-        count++;
-    return count;
-}
-
 static void
-text_page(game_t *game, panel_t *terrain, const char *p, int w, int h)
+text_page(game_t *game, panel_t *terrain, const text_t *text, int w, int h)
 {
     panel_t page;
     panel_center_init(&page, w + 4, h + 2);
     display_push(&page);
     font_t border = FONT(K, k);
-    int numlines = text_numlines(p);
+    int numlines = text->lines;
     int topline = 0;
-    const char *top = p;
+    static template_t up = TEMPLATE("Rk{↑}");
+    static template_t thumb = TEMPLATE("wk{o}");
+    static template_t down = TEMPLATE("Rk{↓}");
 
     int key = 0;
     do {
         switch (key) {
         case ARROW_D:
-            if (topline < numlines - h) {
+            if (topline < numlines - h)
                 topline++;
-                top = text_next_line(top);
-            }
             break;
         case ARROW_U:
-            if (topline > 1) {
+            if (topline > 0)
                 topline--;
-                top = text_prev_line(top);
-            } else if (topline == 1) {
-                topline = 0;
-                top = p;
-            }
             break;
         }
         panel_fill(&page, FONT_DEFAULT, ' ');
         panel_border(&page, border);
         if (numlines > h) {
-            panel_printf(&page, w + 3, 1, "Rk{↑}");
+            panel_template(&page, w + 3, 1, &up);
             int o = (topline / (float)(numlines - h)) * (h - 3);
-            panel_printf(&page, w + 3, o + 2, "wk{o}");
-            panel_printf(&page, w + 3, h, "Rk{↓}");
-        }
-        const char *line = top;
-        for (int y = 0; y < h && topline + y < numlines; y++) {
-            int length = text_linelen(line);
-            char copy[length + 1];
-            memcpy(copy, line, length);
-            copy[length] = '\0';
-            panel_printf(&page, 2, y + 1, copy);
-            line = text_next_line(line);
+            panel_template(&page, w + 3, o + 2, &thumb);
+            panel_template(&page, w + 3, h, &down);
         }
+        for (int y = 0; y < h && topline + y < numlines; y++)
+            panel_text(&page, 2, y + 1, text, topline + y);
     } while (!is_exit_key(key = game_getch(game, terrain)));
 
     display_pop_free();
@@ -603,87 +636,125 @@ text_page(game_t *game, panel_t *terrain, const char *p, int w, int h)
 static void
 ui_story(game_t *game, panel_t *terrain)
 {
-    extern const char _binary_doc_story_txt_start[];
-    text_page(game, terrain, _binary_doc_story_txt_start, 60, 20);
+    extern const text_t text_story;
+    text_page(game, terrain, &text_story, 60, 20);
 }
 
 static void
 ui_help(game_t *game, panel_t *terrain)
 {
-    extern const char _binary_doc_help_txt_start[];
-    text_page(game, terrain, _binary_doc_help_txt_start, 60, 19);
+    extern const text_t text_help;
+    text_page(game, terrain, &text_help, 60, 19);
 }
 
 static void
 ui_gameover(game_t *game, panel_t *terrain)
 {
-    extern const char _binary_doc_game_over_txt_start[];
-    text_page(game, terrain, _binary_doc_game_over_txt_start, 60, 16);
+    extern const text_t text_game_over;
+    text_page(game, terrain, &text_game_over, 60, 16);
 }
 
 static void
 ui_halfway(game_t *game, panel_t *terrain)
 {
-    extern const char _binary_doc_halfway_txt_start[];
-    text_page(game, terrain, _binary_doc_halfway_txt_start, 60, 16);
+    extern const text_t text_halfway;
+    text_page(game, terrain, &text_halfway, 60, 16);
 }
 
 static void
 ui_win(game_t *game, panel_t *terrain)
 {
-    extern const char _binary_doc_win_txt_start[];
-    text_page(game, terrain, _binary_doc_win_txt_start, 60, 16);
+    extern const text_t text_win;
+    text_page(game, terrain, &text_win, 60, 16);
 }
 
 static void
 ui_apology(game_t *game, panel_t *terrain)
 {
-    extern const char _binary_doc_apology_txt_start[];
+    extern const text_t text_apology;
     if (!game->apology_given)
-        text_page(game, terrain, _binary_doc_apology_txt_start, 60, 14);
+        text_page(game, terrain, &text_apology, 60, 14);
     game->apology_given = true;
 }
 
-int
-main(void)
+/**
+ * Wait for a key, drawing the world for SEED and ENGINE into WORLD as
+ * it is generated.
+ */
+static int
+preview_getch(uint64_t seed, enum map_engine engine, panel_t *world)
 {
-    int w, h;
-    display_init();
-    device_terminal_size(&w, &h);
-    if (w < DISPLAY_WIDTH || h < DISPLAY_HEIGHT) {
-        display_free();
-        printf("Goblin-COM requires a terminal of at least %dx%d characters!\n"
-               "I see %dx%d\n"
-               "Press enter to exit ...\n",
-               DISPLAY_WIDTH, DISPLAY_HEIGHT, w, h);
-        fflush(stdout);
-        getchar();
-        exit(EXIT_FAILURE);
+    for (;;) {
+        if (!map_preview(seed, engine, world))
+            panel_clear(world);
+        display_refresh();
+        if (device_tick(PERIOD))
+            return device_getch();
     }
-    device_entropy(&rand_state, sizeof(rand_state));
-    device_title("Goblin-COM");
+}
 
-    panel_t loading;
-    uint8_t loading_message[] = "Initializing world ...";
-    panel_center_init(&loading, sizeof(loading_message), 1);
-    display_push(&loading);
-    panel_puts(&loading, 0, 0, FONT_DEFAULT, (char *)loading_message);
-    display_refresh();
-    game_t *game;
-    FILE *save = fopen(PERSIST_FILE, "rb");
-    if (save) {
-        game = game_load(save);
-        fclose(save);
-        game->speed = SPEED_FACTOR;
-        unlink(PERSIST_FILE);
-    } else {
-        game = game_create(xorshift(&rand_state));
-        game->speed = SPEED_FACTOR;
-    }
-    atexit_save_game = game;
-    atexit(atexit_save);
+/**
+ * Title screen, up over WORLD while the world for SEED is generated.
+ * A new game's world may be switched to another *ENGINE, or made
+ * *SCALE times the size of a classic world each way, which only fBm
+ * can do and which there is no preview of. Returns false if the player
+ * quits from here.
+ */
+static bool
+ui_title(uint64_t seed, enum map_engine *engine, int *scale, panel_t *world,
+         bool resume)
+{
+    static const int scales[] = {1, 4, 16, 64};
+    panel_t title;
+    panel_center_init(&title, 32, 9);
+    display_push(&title);
+    int key;
+    do {
+        panel_fill(&title, FONT_DEFAULT, ' ');
+        panel_border(&title, FONT(K, k));
+        panel_puts(&title, 11, 1, FONT(W, k), "Goblin-COM");
+        panel_printf(&title, 3, 3, "Rk{Enter}  %s",
+                     resume ? "Continue your game" : "Begin a new game");
+        panel_printf(&title, 3, 4, "Rk{t}      Read the story");
+        panel_printf(&title, 3, 5, "Rk{q}      Quit");
+        if (!resume) {
+            panel_printf(&title, 3, 6, "Rk{w}      Terrain: %s",
+                         *engine == MAP_FBM ? "fBm" : "classic");
+            panel_printf(&title, 3, 7, "Rk{z}      Size: %dx%d",
+                         MAP_WIDTH * *scale, MAP_HEIGHT * *scale);
+        }
+        key = preview_getch(seed, *engine, world);
+        if (key == 't') {
+            ui_story(NULL, NULL);
+        } else if ((key == 'w' || key == 'z') && !resume) {
+            world_discard(seed, *engine);
+            if (key == 'w') {
+                *engine = *engine == MAP_FBM ? MAP_DIAMOND_SQUARE : MAP_FBM;
+                *scale = 1;
+            } else {
+                unsigned i = 0;
+                while (scales[i] != *scale)
+                    i++;
+                *scale = scales[(i + 1) % countof(scales)];
+                *engine = MAP_FBM;
+            }
+            if (*scale == 1)
+                world_prefetch(seed, *engine);
+        }
+    } while (key != 13 && key != ' ' && !is_exit_key(key));
     display_pop_free();
+    display_refresh();
+    return !is_exit_key(key);
+}
 
+/**
+ * Run GAME until the player quits or the game ends. Returns true if
+ * it ended, having started on the next world, from *NEXT, in case
+ * the player goes on to another game.
+ */
+static bool
+play_game(game_t *game, journal_t *journal, uint64_t *next)
+{
     panel_t sidemenu;
     panel_init(&sidemenu, DISPLAY_WIDTH - SIDEMENU_WIDTH, 0,
                SIDEMENU_WIDTH, DISPLAY_HEIGHT);
@@ -701,16 +772,37 @@ main(void)
     panel_init(&units, 0, 0, MAP_WIDTH, MAP_HEIGHT);
     display_push(&units);
 
+    view_x = CASTLE_X(game->map) - MAP_WIDTH / 2;
+    view_y = CASTLE_Y(game->map) - MAP_HEIGHT / 2;
+    view_clamp(game);
+
     /* Main Loop */
+    rewind_t *timeline = rewind_create(REWIND_BUDGET);
+#ifndef _WIN32
+    server_session_timeline(timeline);
+#endif
+    rewind_push(timeline, game);
     bool running = true;
-    while (running) {
-        yield_t diff;
-        for (int i = 0; running && i < game->speed; i++) {
+    bool over = false;
+    yield_t diff = {0};
+    for (unsigned long frame = 0; running; frame++) {
+        if (journal && frame % CHECK_INTERVAL == 0)
+            journal_check(journal, game_hash(game));
+        int steps = game->speed * device_frames();
+        for (int i = 0; running && i < steps; i++) {
             diff = game_step(game);
             enum game_event event;
             while ((event = game_event_pop(game)) != EVENT_NONE) {
                 sidemenu_draw(&sidemenu, game, diff);
                 display_refresh();
+                if ((event == EVENT_LOSE || event == EVENT_WIN) && !over) {
+                    /* Speculate on another game while the ending is read. */
+                    over = true;
+                    *next = xorshift(&rand_state);
+                    if (game->map->width == MAP_WIDTH &&
+                        game->map->height == MAP_HEIGHT)
+                        world_prefetch(*next, game->map->engine);
+                }
                 switch (event) {
                 case EVENT_LOSE:
                     atexit_save_game = NULL;
@@ -732,21 +824,18 @@ main(void)
                     break;
                 }
             }
+            if (game->time % (long)HOUR == 0)
+                rewind_push(timeline, game);
         }
 
         sidemenu_draw(&sidemenu, game, diff);
-        map_draw_terrain(game->map, &terrain);
-        panel_clear(&buildings);
-        map_draw_buildings(game->map, &buildings);
-        panel_clear(&units);
-        game_draw_units(game, &units, false);
+        view_draw(game, &terrain, &buildings, &units);
         display_refresh();
-        uint64_t wait = device_uepoch() % PERIOD;
-        if (device_kbhit(wait)) {
+        if (device_tick(PERIOD)) {
             int key = device_getch();
             switch (key) {
             case 'b':
-                ui_build(game, &terrain);
+                ui_build(game, &terrain, &buildings, &units);
                 break;
             case 's':
                 ui_squads(game, &terrain, &units);
@@ -771,6 +860,9 @@ main(void)
                 if (game->speed == 0)
                     game->speed = 1;
                 break;
+            case 'r':
+                rewind_restore(timeline, game, game->time - (long)HOUR);
+                break;
             case 'R':
                 display_invalidate();
                 break;
@@ -782,15 +874,25 @@ main(void)
                 if (!running)
                     atexit_save_game = NULL;
                 break;
-            default:
-                break;
+            default: {
+                int dx = 0, dy = 0;
+                if (arrow_delta(key, &dx, &dy)) {
+                    device_motion(&dx, &dy);
+                    view_x += dx * VIEW_MARGIN_X;
+                    view_y += dy * VIEW_MARGIN_Y;
+                    view_clamp(game);
+                }
+            } break;
             }
         }
     };
 
-    atexit_save();
-    atexit_save_game = NULL;
-    game_free(game);
+    if (journal)
+        journal_check(journal, game_hash(game));
+#ifndef _WIN32
+    server_session_timeline(NULL);
+#endif
+    rewind_free(timeline);
 
     display_pop(); // units
     display_pop(); // buildings
@@ -800,6 +902,450 @@ main(void)
     panel_free(&buildings);
     panel_free(&terrain);
     panel_free(&sidemenu);
+    return over;
+}
+
+/**
+ * Play on the current display, from the title screen through as many
+ * games as the player likes. A persistent game is resumed from and
+ * saved to PERSIST_FILE. The device logs the game's inputs
+ * to JOURNAL, or replays them from it, and owns it from here on.
+ */
+static void
+play(bool persistent, journal_t *journal)
+{
+    int w, h;
+    device_journal(journal);
+    display_init();
+    device_terminal_size(&w, &h);
+    if (w < DISPLAY_WIDTH || h < DISPLAY_HEIGHT) {
+        if (!persistent) {
+            popup_message(font_error, "Goblin-COM requires %dx%d, I see %dx%d",
+                          DISPLAY_WIDTH, DISPLAY_HEIGHT, w, h);
+            display_free();
+            return;
+        }
+        display_free();
+        printf("Goblin-COM requires a terminal of at least %dx%d characters!\n"
+               "I see %dx%d\n"
+               "Press enter to exit ...\n",
+               DISPLAY_WIDTH, DISPLAY_HEIGHT, w, h);
+        fflush(stdout);
+        getchar();
+        exit(EXIT_FAILURE);
+    }
+    device_entropy(&rand_state, sizeof(rand_state));
+    device_title("Goblin-COM");
+
+    /* The world is generated while the title screen is up. */
+    uint64_t seed;
+    enum map_engine engine = MAP_DIAMOND_SQUARE;
+    int scale = 1;
+    FILE *save = persistent ? fopen(PERSIST_FILE, "rb") : NULL;
+    save = journal_file(journal, save);
+    if (save && !game_peek_seed(save, &seed, &engine)) {
+        fclose(save);
+        save = NULL;
+    }
+    if (!save)
+        seed = xorshift(&rand_state);
+    world_prefetch(seed, engine);
+    panel_t world;
+    panel_init(&world, 0, 0, MAP_WIDTH, MAP_HEIGHT);
+    display_push(&world);
+    if (!ui_title(seed, &engine, &scale, &world, save != NULL)) {
+        world_discard(seed, engine);
+        if (save)
+            fclose(save);
+        display_pop();
+        panel_free(&world);
+        display_free();
+        return;
+    }
+    if (persistent)
+        atexit(atexit_save);
+
+    for (bool again = true; again;) {
+        panel_t loading;
+        uint8_t loading_message[] = "Initializing world ...";
+        panel_center_init(&loading, sizeof(loading_message), 1);
+        display_push(&loading);
+        panel_puts(&loading, 0, 0, FONT_DEFAULT, (char *)loading_message);
+        while (!journal_int(journal, JOURNAL_READY, map_ready(seed, engine))) {
+            if (!map_preview(seed, engine, &world))
+                panel_clear(&world);
+            display_refresh();
+            if (device_tick(PERIOD))
+                device_getch(); // no input until the world is ready
+        }
+        display_refresh();
+        game_t *game;
+        if (save) {
+            game = game_load(save);
+            fclose(save);
+            save = NULL;
+            if (persistent)
+                unlink(PERSIST_FILE);
+        } else {
+            game = game_create(seed, engine,
+                               MAP_WIDTH * scale, MAP_HEIGHT * scale);
+        }
+        game->speed = SPEED_FACTOR;
+        if (persistent)
+            atexit_save_game = game;
+#ifndef _WIN32
+        server_session_game(game);
+        server_session_world(seed, engine, false); // collected
+#endif
+        display_pop_free();
+
+        again = play_game(game, journal, &seed);
+        atexit_save();
+        atexit_save_game = NULL;
+#ifndef _WIN32
+        server_session_game(NULL);
+#endif
+        game_free(game);
+        if (again && !(again = popup_confirm("Start a new game? (Rk{y}/Rk{n})")))
+            world_discard(seed, engine);
+    }
+    display_pop(); // world
+    panel_free(&world);
+    display_free();
+}
+
+
+/**
+ * Play back a recording. Space pauses, < and > change the speed, and
+ * the arrow keys seek by ten seconds (up and down by a minute).
+ */
+static int
+replay(const char *path)
+{
+    replay_t *r = replay_open(path);
+    if (!r) {
+        fprintf(stderr, "gcom: %s: not a readable recording\n", path);
+        return EXIT_FAILURE;
+    }
+    display_init();
+    panel_t screen;
+    panel_init(&screen, 0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    display_push(&screen);
+    uint64_t duration = replay_duration(r);
+    uint64_t base = 0; // position at ANCHOR, msec
+    uint64_t anchor = device_uepoch();
+    int speed = 1;
+    bool paused = false;
+    char title[64] = "";
+    for (bool running = true; running;) {
+        uint64_t now = device_uepoch();
+        uint64_t position = base;
+        if (!paused)
+            position += (now - anchor) / 1000 * speed;
+        if (position >= duration) {
+            position = base = duration;
+            paused = true;
+        }
+        while (replay_next(r, position));
+        for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+            for (int x = 0; x < DISPLAY_WIDTH; x++) {
+                font_t font;
+                uint16_t c = replay_cell(r, x, y, &font);
+                panel_putc(&screen, x, y, font, c);
+            }
+        }
+        char status[64];
+        snprintf(status, sizeof(status), "Replay %d:%02d / %d:%02d x%d%s",
+                 (int)(position / 60000), (int)(position / 1000 % 60),
+                 (int)(duration / 60000), (int)(duration / 1000 % 60),
+                 speed, paused ? " (paused)" : "");
+        if (strcmp(status, title)) {
+            device_title(status);
+            strcpy(title, status);
+        }
+        display_refresh();
+        if (!device_tick(PERIOD))
+            continue;
+        int64_t seek = 0;
+        switch (device_getch()) {
+        case ' ':
+            paused = !paused;
+            break;
+        case '>':
+        case '.':
+            if (speed < 64)
+                speed *= 2;
+            break;
+        case '<':
+        case ',':
+            if (speed > 1)
+                speed /= 2;
+            break;
+        case ARROW_R:
+            seek = 10000;
+            break;
+        case ARROW_L:
+            seek = -10000;
+            break;
+        case ARROW_U:
+            seek = 60000;
+            break;
+        case ARROW_D:
+            seek = -60000;
+            break;
+        case 'q':
+        case 'Q':
+        case 27:
+            running = false;
+            break;
+        }
+        base = position;
+        anchor = now;
+        if (seek) {
+            if (seek < 0 && (uint64_t)-seek > position)
+                base = 0;
+            else
+                base = position + seek > duration ? duration : position + seek;
+            if (base < position)
+                paused = false;
+            replay_seek(r, base);
+        }
+    }
+    display_pop();
+    panel_free(&screen);
     display_free();
+    replay_close(r);
+    return 0;
+}
+
+/**
+ * Write a recording to standard output as ANSI text: the screen at
+ * SECONDS, or the whole session when SECONDS is NULL.
+ */
+static int
+export(const char *path, const char *seconds)
+{
+    replay_t *r = replay_open(path);
+    if (!r) {
+        fprintf(stderr, "gcom: %s: not a readable recording\n", path);
+        return EXIT_FAILURE;
+    }
+    if (seconds)
+        replay_seek(r, atof(seconds) * 1000);
+    replay_export(r, stdout, !seconds);
+    replay_close(r);
+    return 0;
+}
+
+/* A file for local play, a directory of per-session files when serving */
+static const char *record_path;
+static bool record_off;
+
+static bool
+record_start(const char *path)
+{
+    record_t *r = record_create(path);
+    if (!r) {
+        fprintf(stderr, "gcom: %s: ", path);
+        perror(NULL);
+        return false;
+    }
+    display_record(r);
+    return true;
+}
+
+static const char *journal_path; // likewise
+static bool journal_off;
+
+static journal_t *
+journal_start(const char *path)
+{
+    journal_t *j = journal_create(path);
+    if (!j) {
+        fprintf(stderr, "gcom: %s: ", path);
+        perror(NULL);
+    }
+    return j;
+}
+
+#ifndef _WIN32
+static void
+session(void)
+{
+    static unsigned count;
+    char path[4096];
+    uint64_t stamp = device_uepoch();
+    journal_t *journal = NULL;
+    if (record_path) {
+        snprintf(path, sizeof(path), "%s/%" PRIu64 "-%u.gcr",
+                 record_path, stamp, count);
+        record_start(path);
+    }
+    if (journal_path) {
+        snprintf(path, sizeof(path), "%s/%" PRIu64 "-%u.gcj",
+                 journal_path, stamp, count);
+        journal = journal_start(path);
+    }
+    count++;
+    play(false, journal);
+}
+
+static uint64_t verify_start;
+static int verify_status = EXIT_FAILURE;
+static jmp_buf verify_stop;
+
+static void
+verify_done(journal_t *j, bool closed)
+{
+    double seconds = (device_uepoch() - verify_start) / 1e6;
+    printf("%s after %" PRIu64 " device calls, %u state checks passed, "
+           "%.3f seconds\n", journal_diverged(j) ? "DIVERGED" : "ok",
+           journal_calls(j), journal_checks(j), seconds);
+    verify_status = journal_diverged(j) ? EXIT_FAILURE : EXIT_SUCCESS;
+    if (!closed)
+        longjmp(verify_stop, 1); // nothing is left to answer the game
+}
+
+/**
+ * Re-run a journaled game headless, as fast as possible, checking
+ * that it passes through the same states.
+ */
+static int
+verify(const char *path)
+{
+    journal_t *j = journal_open(path, verify_done);
+    if (!j) {
+        fprintf(stderr, "gcom: %s: not a readable journal\n", path);
+        return EXIT_FAILURE;
+    }
+    if (!device_headless()) {
+        perror("gcom: headless device");
+        return EXIT_FAILURE;
+    }
+    verify_start = device_uepoch();
+    /* A game that outlives its journal is left where it stands, as the
+     * server leaves a dropped session, and the process ends with it. */
+    if (!setjmp(verify_stop))
+        play(false, j); // closes the journal on the way out
+    return verify_status;
+}
+#endif
+
+static void
+usage(FILE *out)
+{
+    fprintf(out, "usage: gcom [--record FILE] [--journal FILE]\n"
+                 "       gcom --replay FILE\n"
+                 "       gcom --export FILE [SECONDS]\n"
+                 "       gcom --bot [SEED]\n"
+#ifndef _WIN32
+                 "       gcom --verify FILE\n"
+                 "       gcom --serve PORT [--record DIR] [--journal DIR]\n"
+                 "       gcom --broadcast PORT [--record FILE] "
+                 "[--journal FILE]\n"
+#endif
+                 "Games are recorded into " RECORD_FILE " and journaled "
+                 "into " JOURNAL_FILE
+#ifndef _WIN32
+                 ",\nor into " SESSION_DIR "/ when serving"
+#endif
+                 ". --no-record and --no-journal turn\neither off.\n"
+                 );
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *replay_file = NULL;
+    const char *export_file = NULL;
+    const char *export_time = NULL;
+    const char *verify_file = NULL;
+    const char *bot_seed = NULL;
+    bool bot = false;
+    int serve = 0;
+    int broadcast = 0;
+    for (int i = 1; i < argc; i++) {
+        bool arg = i + 1 < argc;
+        if (arg && strcmp(argv[i], "--record") == 0) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--no-record") == 0) {
+            record_off = true;
+        } else if (arg && strcmp(argv[i], "--journal") == 0) {
+            journal_path = argv[++i];
+        } else if (strcmp(argv[i], "--no-journal") == 0) {
+            journal_off = true;
+        } else if (arg && strcmp(argv[i], "--replay") == 0) {
+            replay_file = argv[++i];
+        } else if (arg && strcmp(argv[i], "--export") == 0) {
+            export_file = argv[++i];
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+                export_time = argv[++i];
+        } else if (strcmp(argv[i], "--bot") == 0) {
+            bot = true;
+            if (arg && isdigit(argv[i + 1][0]))
+                bot_seed = argv[++i];
+#ifndef _WIN32
+        } else if (arg && strcmp(argv[i], "--verify") == 0) {
+            verify_file = argv[++i];
+        } else if (arg && strcmp(argv[i], "--serve") == 0) {
+            serve = atoi(argv[++i]);
+        } else if (arg && strcmp(argv[i], "--broadcast") == 0) {
+            broadcast = atoi(argv[++i]);
+#endif
+        } else {
+            usage(stderr);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (replay_file)
+        return replay(replay_file);
+    if (export_file)
+        return export(export_file, export_time);
+    if (bot) {
+        if (bot_seed)
+            rand_state = strtoull(bot_seed, NULL, 10);
+        else
+            device_entropy(&rand_state, sizeof(rand_state));
+        return bot_run(stdin, stdout, xorshift(&rand_state));
+    }
+#ifndef _WIN32
+    if (verify_file)
+        return verify(verify_file);
+    if (serve) {
+        const char **paths[] = {&record_path, &journal_path};
+        bool off[] = {record_off, journal_off};
+        for (int i = 0; i < 2; i++) {
+            if (off[i]) {
+                *paths[i] = NULL;
+            } else if (!*paths[i]) {
+                mkdir(SESSION_DIR, 0777); // failures show with the first game
+                *paths[i] = SESSION_DIR;
+            }
+        }
+        return server_run(serve, session);
+    }
+    if (broadcast && broadcast_start(broadcast) < 0) {
+        perror("gcom: listen");
+        return EXIT_FAILURE;
+    }
+#endif
+    (void) serve;
+    (void) broadcast;
+    (void) verify_file;
+    if (!record_off && record_path) {
+        if (!record_start(record_path))
+            return EXIT_FAILURE;
+    } else if (!record_off && !record_start(RECORD_FILE)) {
+        fputs("gcom: playing on without a recording\n", stderr);
+    }
+    journal_t *journal = NULL;
+    if (!journal_off && journal_path) {
+        if (!(journal = journal_start(journal_path)))
+            return EXIT_FAILURE;
+    } else if (!journal_off && !(journal = journal_start(JOURNAL_FILE))) {
+        fputs("gcom: playing on without a journal\n", stderr);
+    }
+    play(true, journal);
     return 0;
 }
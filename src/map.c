@@ -1,147 +1,730 @@
+#define _GNU_SOURCE
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
 #include "map.h"
 #include "rand.h"
+#ifndef _WIN32
+#include <pthread.h>
+#include <sys/mman.h>
+#endif
 
 #define WORK_SIZE 4097
+#define WORK_BYTES (WORK_SIZE * WORK_SIZE * sizeof(height_t))
+#define HUGE_PAGE (2UL * 1024 * 1024)
 #define NOISE_SCALE 4.0f
+#define PREVIEW_SAMPLES 4 // per side of a cell
 
-static size_t
-grow(const float *map, size_t size, float *out, uint64_t *seed)
+/* Low resolution heights, MAP_WIDTH by MAP_HEIGHT samples per cell,
+ * are the top left corner of the finished working grid. */
+#define LOW_WIDTH (MAP_WIDTH * MAP_WIDTH)
+#define LOW_HEIGHT (MAP_HEIGHT * MAP_HEIGHT)
+#define LOW(low, x, y) (low)[(y) * WORK_SIZE + (x)]
+
+#ifdef MAP_HEIGHT16
+/* Heights in fixed point, HEIGHT_ONE to 1.0, for half the memory
+ * traffic. Noise keeps heights within 2.75 either way, and the falloff
+ * takes them no lower than -4.2, which is clamped to -4 (still ocean). */
+typedef int16_t height_t;
+typedef int32_t height_sum_t;
+#define HEIGHT_ONE 8192.0f
+#else
+typedef float height_t;
+typedef float height_sum_t;
+#define HEIGHT_ONE 1.0f
+#endif
+
+static inline height_t
+height_q(float f)
 {
-    size_t osize = (size - 1) * 2 + 1;
-    /* Copy */
-    for (size_t y = 0; y < size; y++) {
-        for (size_t x = 0; x < size; x++) {
-            out[y * 2 * osize + x * 2] = map[y * size + x];
-        }
+#ifdef MAP_HEIGHT16
+    return f * HEIGHT_ONE + copysignf(0.5f, f); // rounded, as it truncates
+#else
+    return f;
+#endif
+}
+
+static inline float
+height_f(height_sum_t h)
+{
+    return h / HEIGHT_ONE;
+}
+
+static inline height_t
+height_mean4(height_sum_t sum)
+{
+#ifdef MAP_HEIGHT16
+    return (sum + 1 + (sum >> 2 & 1)) >> 2; // ties to even, so no drift
+#else
+    return sum / 4;
+#endif
+}
+
+static inline height_t
+height_mean3(height_sum_t sum)
+{
+#ifdef MAP_HEIGHT16
+    return (sum + (sum < 0 ? -1 : 1)) / 3;
+#else
+    return sum / 3;
+#endif
+}
+
+/**
+ * H lowered by F.
+ */
+static inline height_t
+height_lower(height_t h, float f)
+{
+#ifdef MAP_HEIGHT16
+    height_sum_t lowered = h - (height_sum_t)height_q(f);
+    return lowered < -4 * HEIGHT_ONE ? -4 * HEIGHT_ONE : lowered;
+#else
+    return h - f;
+#endif
+}
+
+typedef struct job job_t;
+
+/* Shown a sketch of a world after each coarse LEVEL of its heightmap,
+ * counting from 1; returning false abandons the world. */
+typedef bool watch_fn(void *arg, int level,
+                      uint16_t sketch[MAP_WIDTH][MAP_HEIGHT]);
+
+/* The working grid is WORK_SIZE points on a side and is refined in
+ * place: a level with points STEP apart is turned into one with points
+ * STEP / 2 apart, leaving the points already there untouched. */
+
+/**
+ * Diamond step for one row: the centre of each square of points from
+ * rows UP and DOWN, H either side.
+ */
+static void
+diamond_row(height_t *row, const height_t *up, const height_t *down,
+            size_t h, const height_t *noise)
+{
+    for (size_t x = h; x < WORK_SIZE; x += 2 * h) {
+        height_sum_t sum = up[x - h] + up[x + h] + down[x - h] + down[x + h];
+        row[x] = height_mean4(sum) + *noise++;
     }
-    /* Diamond */
-    for (size_t y = 1; y < osize; y += 2) {
-        for (size_t x = 1; x < osize; x += 2) {
-            int count = 0;
-            float sum = 0;
-            for (int dy = -1; dy <= 1; dy += 2) {
-                for (int dx = -1; dx <= 1; dx += 2) {
-                    long i = (y + dy) * osize + (x + dx);
-                    if (i >= 0 && (size_t)i < osize * osize) {
-                        sum += out[i];
-                        count++;
-                    }
-                }
-            }
-            float u = rand_uniform_s(seed, -1, 1);
-            out[y * osize + x] = sum / count + u / osize * NOISE_SCALE;
+}
+
+/**
+ * Square step for one row, for points from X on, 2H apart: each from
+ * its neighbours H away in the row and in rows UP and DOWN. Either of
+ * those is NULL at the top or bottom of the grid, and points at the
+ * sides have one neighbour less.
+ */
+static void
+square_row(height_t *row, const height_t *up, const height_t *down,
+           size_t x, size_t h, const height_t *noise)
+{
+    const size_t last = WORK_SIZE - 1;
+    if (!up || !down) {
+        const height_t *near = up ? up : down; // x is never at a side here
+        for (; x < last; x += 2 * h) {
+            height_sum_t sum = row[x - h] + row[x + h] + near[x];
+            row[x] = height_mean3(sum) + *noise++;
         }
+        return;
     }
-    /* Square */
-    struct {
-        int x, y;
-    } pos[] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
-    for (size_t y = 1; y < osize; y++) {
-        for (size_t x = (y + 1) % 2; x < osize; x += 2) {
-            int count = 0;
-            float sum = 0;
-            for (int p = 0; p < 4; p++) {
-                long i = (y + pos[p].y) * osize + (x + pos[p].x);
-                if (i >= 0 && (size_t)i < osize * osize) {
-                    sum += out[i];
-                    count++;
-                }
-            }
-            float u = rand_uniform_s(seed, -1, 1);
-            out[y * osize + x] = sum / count + u / osize  * NOISE_SCALE;
-        }
+    if (x == 0) {
+        row[0] = height_mean3(row[h] + up[0] + down[0]) + *noise++;
+        x = 2 * h;
     }
-    return osize;
+    for (; x < last; x += 2 * h) {
+        height_sum_t sum = row[x - h] + row[x + h] + up[x] + down[x];
+        row[x] = height_mean4(sum) + *noise++;
+    }
+    if (x == last)
+        row[x] = height_mean3(row[x - h] + up[x] + down[x]) + *noise++;
+}
+
+/**
+ * N noise offsets of up to AMP either way.
+ */
+static void
+noise_draw(xoshiro_t *rng, height_t *out, size_t n, float amp)
+{
+    float u[WORK_SIZE];
+    xoshiro_uniform(rng, u, n, -1, 1);
+    for (size_t i = 0; i < n; i++)
+        out[i] = height_q(u[i] * amp);
 }
 
+/**
+ * Refine GRID from points STEP apart to STEP / 2. Diamond and square
+ * steps are fused into one sweep down the rows, so that only three
+ * rows are worked on at a time: a row's square step follows as soon as
+ * the diamond rows either side of it are done.
+ */
 static void
-summarize(map_t *map, uint64_t *seed)
+refine(height_t *grid, size_t step, xoshiro_t *rng)
+{
+    size_t h = step / 2;
+    size_t size = (WORK_SIZE - 1) / h + 1;
+    float amp = NOISE_SCALE / size;
+    height_t noise[WORK_SIZE]; // one row's worth
+    const size_t line = h * WORK_SIZE;
+    for (size_t y = h; y < WORK_SIZE; y += step) {
+        height_t *row = grid + y * WORK_SIZE;
+        height_t *up = row - line;
+        noise_draw(rng, noise, size / 2, amp);
+        diamond_row(row, up, row + line, h, noise);
+        noise_draw(rng, noise, size / 2, amp);
+        square_row(up, y > h ? up - line : NULL, row, h, h, noise);
+        noise_draw(rng, noise, (size + 1) / 2, amp);
+        square_row(row, up, row + line, 0, h, noise);
+    }
+    height_t *bottom = grid + (WORK_SIZE - 1) * WORK_SIZE;
+    noise_draw(rng, noise, size / 2, amp);
+    square_row(bottom, bottom - line, NULL, h, h, noise);
+}
+
+/* The base each kind of stored terrain is drawn and reported as. */
+static const uint16_t terrain_bases[] = {
+    [TERRAIN_OCEAN]     = BASE_OCEAN,
+    [TERRAIN_COAST]     = BASE_COAST,
+    [TERRAIN_SAND]      = BASE_SAND,
+    [TERRAIN_GRASSLAND] = BASE_GRASSLAND,
+    [TERRAIN_FOREST]    = BASE_FOREST,
+    [TERRAIN_HILL]      = BASE_HILL,
+    [TERRAIN_MOUNTAIN]  = BASE_MOUNTAIN,
+};
+
+static enum map_terrain
+terrain_of(uint16_t base)
+{
+    for (unsigned t = 0; t < countof(terrain_bases); t++)
+        if (terrain_bases[t] == base)
+            return t;
+    return TERRAIN_OCEAN;
+}
+
+/**
+ * Terrain for a cell from the mean and spread of its heights. Flat
+ * land is BASE_GRASSLAND, some of which summarize() turns to forest.
+ */
+static enum map_base
+classify(float mean, float std)
+{
+    if (mean < -0.8)
+        return BASE_OCEAN;
+    else if (mean < -0.6)
+        return BASE_COAST;
+    else if (mean < -0.5)
+        return BASE_SAND;
+    else if (std > 0.05)
+        return BASE_MOUNTAIN;
+    else if (std > 0.04)
+        return BASE_HILL;
+    else
+        return BASE_GRASSLAND;
+}
+
+/* Falloff towards the edge of a world of WIDTH by HEIGHT squares, in
+ * low resolution units. */
+static inline float
+falloff(float x, float y, int width, int height)
 {
+    float sx = x / (float)(width * MAP_WIDTH) - 0.5;
+    float sy = y / (float)(height * MAP_HEIGHT) - 0.5;
+    return sqrt(sx * sx + sy * sy) * 3 - 0.45f;
+}
+
+static inline map_chunk_t *chunk_get(map_t *, int cx, int cy);
+
+static void
+summarize(map_t *map, const height_t *low, xoshiro_t *rng)
+{
+    map_chunk_t *chunk = chunk_get(map, 0, 0); // all of a classic world
+    float forest[MAP_HEIGHT][MAP_WIDTH];
+    xoshiro_uniform(rng, forest[0], MAP_HEIGHT * MAP_WIDTH, -1, 1);
     for (size_t y = 0; y < MAP_HEIGHT; y++) {
         for (size_t x = 0; x < MAP_WIDTH; x++) {
-            float mean = 0;
+            height_sum_t sum = 0;
             for (size_t sy = 0; sy < MAP_HEIGHT; sy++) {
                 for (size_t sx = 0; sx < MAP_WIDTH; sx++) {
                     size_t ix = x * MAP_WIDTH + sx;
                     size_t iy = y * MAP_HEIGHT + sy;
-                    mean += map->low[ix][iy].height;
+                    sum += LOW(low, ix, iy);
                 }
             }
-            mean /= (MAP_WIDTH * MAP_HEIGHT);
+            float mean = height_f(sum) / (MAP_WIDTH * MAP_HEIGHT);
             float std = 0;
             for (size_t sy = 0; sy < MAP_HEIGHT; sy++) {
                 for (size_t sx = 0; sx < MAP_WIDTH; sx++) {
                     size_t ix = x * MAP_WIDTH + sx;
                     size_t iy = y * MAP_HEIGHT + sy;
-                    float diff = mean - map->low[ix][iy].height;
+                    float diff = mean - height_f(LOW(low, ix, iy));
                     std += diff * diff;
                 }
             }
             std = sqrt(std / (MAP_HEIGHT * MAP_WIDTH));
-            enum map_base base;
-            if (mean < -0.8)
-                base = BASE_OCEAN;
-            else if (mean < -0.6)
-                base = BASE_COAST;
-            else if (mean < -0.5)
-                base = BASE_SAND;
-            else if (std > 0.05)
-                base = BASE_MOUNTAIN;
-            else if (std > 0.04)
-                base = BASE_HILL;
-            else if (rand_uniform_s(seed, -1, 1) > -0.2)
-                base = BASE_GRASSLAND;
-            else
+            enum map_base base = classify(mean, std);
+            if (base == BASE_GRASSLAND && forest[y][x] <= -0.2)
                 base = BASE_FOREST;
-            map->high[x][y].base = base;
-            map->high[x][y].building = 0;
+            chunk->terrain[y][x] = terrain_of(base);
         }
     }
 }
 
-map_t *
-map_generate(uint64_t seed)
-{
-    map_t *map = malloc(sizeof(*map));
-    size_t alloc_size = WORK_SIZE * WORK_SIZE * sizeof(float);
-    float *buf_a = calloc(alloc_size, 1);
-    float *buf_b = calloc(alloc_size, 1);
-    float *heightmap = buf_a;
-    for (int i = 0; i < 4; i++)
-        heightmap[i] = rand_uniform_s(&seed, -1, 1);
-    size_t size = 3;
-    while (size < WORK_SIZE) {
-        size = grow(buf_a, size, buf_b, &seed);
-        heightmap = buf_b;
-        buf_b = buf_a;
-        buf_a = heightmap;
-    }
-    for (size_t y = 0; y < MAP_HEIGHT * MAP_HEIGHT; y++) {
-        for (size_t x = 0; x < MAP_WIDTH * MAP_WIDTH; x++) {
-            float height = heightmap[y * WORK_SIZE + x];
-            float sx = x / (float)(MAP_WIDTH * MAP_WIDTH) - 0.5;
-            float sy = y / (float)(MAP_HEIGHT * MAP_HEIGHT) - 0.5;
-            float s = sqrt(sx * sx + sy * sy) * 3 - 0.45f;
-            map->low[x][y].height = height - s;
+/**
+ * Cheap stand-in for summarize() while the working grid only has
+ * points STEP apart: each cell is classified from a few samples.
+ */
+static void
+preview(const height_t *grid, size_t step,
+        uint16_t out[MAP_WIDTH][MAP_HEIGHT])
+{
+    const int n = PREVIEW_SAMPLES;
+    for (size_t y = 0; y < MAP_HEIGHT; y++) {
+        for (size_t x = 0; x < MAP_WIDTH; x++) {
+            float sum = 0, sum2 = 0;
+            for (int j = 0; j < n; j++) {
+                for (int i = 0; i < n; i++) {
+                    float lx = x * MAP_WIDTH + (i + 0.5f) * MAP_WIDTH / n;
+                    float ly = y * MAP_HEIGHT + (j + 0.5f) * MAP_HEIGHT / n;
+                    size_t gx = (size_t)(lx / step + 0.5f) * step;
+                    size_t gy = (size_t)(ly / step + 0.5f) * step;
+                    float height = height_f(grid[gy * WORK_SIZE + gx]);
+                    height -= falloff(lx, ly, MAP_WIDTH, MAP_HEIGHT);
+                    sum += height;
+                    sum2 += height * height;
+                }
+            }
+            float mean = sum / (n * n);
+            float var = sum2 / (n * n) - mean * mean;
+            out[x][y] = classify(mean, var > 0 ? sqrt(var) : 0);
         }
     }
-    free(buf_a);
-    free(buf_b);
-    summarize(map, &seed);
+}
+
+/* Working grid, kept by each thread from one world to the next. */
+static __thread height_t *arena;
+
+/**
+ * The working grid, backed by huge pages where the system has them,
+ * which saves tens of thousands of page faults per world. Its contents
+ * are whatever the last world left in it.
+ */
+static height_t *
+arena_get(void)
+{
+    if (arena)
+        return arena;
+#ifndef _WIN32
+    size_t size = (WORK_BYTES + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+    int prot = PROT_READ | PROT_WRITE;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void *p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    p = mmap(NULL, size, prot, flags | MAP_HUGETLB, -1, 0);
+#endif
+    if (p == MAP_FAILED) {
+        p = mmap(NULL, size, prot, flags, -1, 0);
+#ifdef MADV_HUGEPAGE
+        if (p != MAP_FAILED)
+            madvise(p, size, MADV_HUGEPAGE);
+#endif
+    }
+    arena = p == MAP_FAILED ? NULL : p;
+#else
+    arena = malloc(WORK_BYTES);
+#endif
+    return arena;
+}
+
+/**
+ * Diamond-square terrain for MAP, showing sketches to WATCH (if any) as
+ * the heightmap is refined. Returns false if WATCH abandoned it.
+ */
+static bool
+diamond_square(map_t *map, uint64_t seed, watch_fn *watch, void *arg)
+{
+    uint16_t coarse[MAP_WIDTH][MAP_HEIGHT];
+    height_t *grid = arena_get();
+    xoshiro_t rng;
+    xoshiro_seed(&rng, seed);
+    float corners[4];
+    xoshiro_uniform(&rng, corners, 4, -1, 1);
+    size_t step = (WORK_SIZE - 1) / 2;
+    for (size_t i = 0; i < 9; i++) {
+        height_t height = height_q(i < 4 ? corners[i] : 0);
+        grid[i / 3 * step * WORK_SIZE + i % 3 * step] = height;
+    }
+    for (int level = 1; step > 1; step /= 2, level++) {
+        refine(grid, step, &rng);
+        if (watch) {
+            preview(grid, step / 2, coarse);
+            if (!watch(arg, level, coarse))
+                return false;
+        }
+    }
+    for (size_t y = 0; y < LOW_HEIGHT; y++) {
+        for (size_t x = 0; x < LOW_WIDTH; x++) {
+            float f = falloff(x, y, MAP_WIDTH, MAP_HEIGHT);
+            LOW(grid, x, y) = height_lower(LOW(grid, x, y), f);
+        }
+    }
+    summarize(map, grid, &rng);
+    return true;
+}
+
+/* The fBm engine sums octaves of value noise, their wavelengths
+ * halving from the scale of the whole world down to a fraction of a
+ * cell, and their amplitudes tuned to make much the same mix of
+ * terrain as diamond-square. It is sampled right where it is needed,
+ * so any cell can be had on its own, and takes a few milliseconds. */
+#define FBM_OCTAVES 8
+#define FBM_WAVELENGTH 2048.0f // low resolution units, first octave
+#define FBM_SAMPLES_X 10 // per cell
+#define FBM_SAMPLES_Y 4
+#define FBM_ROW (CHUNK_WIDTH * FBM_SAMPLES_X)
+
+typedef struct {
+    uint32_t key[FBM_OCTAVES];
+    uint32_t forest;
+} fbm_t;
+
+static void
+fbm_init(fbm_t *f, uint64_t seed)
+{
+    uint64_t state = seed ^ UINT64_C(0x9e3779b97f4a7c15);
+    for (int i = 0; i < FBM_OCTAVES; i++)
+        f->key[i] = xorshift(&state);
+    f->forest = xorshift(&state);
+}
+
+/**
+ * A value in [-1, 1) for lattice point X, Y.
+ */
+static inline float
+fbm_lattice(uint32_t x, uint32_t y, uint32_t key)
+{
+    uint32_t h = (x * 0x8da6b343u) ^ (y * 0xd8163841u) ^ key;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return (int32_t)h * 0x1p-31f;
+}
+
+static inline int32_t
+fbm_floor(float x)
+{
+    int32_t i = x;
+    return i - (x < i);
+}
+
+static inline float
+fbm_smooth(float t)
+{
+    return t * t * (3 - 2 * t);
+}
+
+/**
+ * Heights, before the falloff, at N low resolution points along Y, at
+ * X0 plus DX for each from the FIRST on. Branch-free, so that it
+ * vectorizes.
+ */
+static void
+fbm_row(const fbm_t *f, float x0, float dx, int first, float y, int n,
+        float *out)
+{
+    for (int i = 0; i < n; i++)
+        out[i] = 0;
+    float wavelength = FBM_WAVELENGTH;
+    float amp = 1;
+    for (int o = 0; o < FBM_OCTAVES; o++) {
+        uint32_t key = f->key[o];
+        float fy = y / wavelength;
+        int32_t iy = fbm_floor(fy);
+        float ty = fbm_smooth(fy - iy);
+        for (int i = 0; i < n; i++) {
+            float fx = (x0 + (first + i) * dx) / wavelength;
+            int32_t ix = fbm_floor(fx);
+            float tx = fbm_smooth(fx - ix);
+            float a = fbm_lattice(ix, iy, key);
+            float b = fbm_lattice(ix + 1, iy, key);
+            float c = fbm_lattice(ix, iy + 1, key);
+            float d = fbm_lattice(ix + 1, iy + 1, key);
+            float top = a + (b - a) * tx;
+            float bottom = c + (d - c) * tx;
+            out[i] += (top + (bottom - top) * ty) * amp;
+        }
+        wavelength /= 2;
+        amp *= o ? 0.4f : 0.8f;
+    }
+}
+
+/**
+ * Classify N cells of MAP's row CY, from X0 on, from a grid of samples
+ * in each.
+ */
+static void
+fbm_cells(const fbm_t *f, const map_t *map, int cy, int x0, int n,
+          uint16_t *out)
+{
+    float samples[FBM_SAMPLES_Y][FBM_ROW];
+    float dx = MAP_WIDTH / (float)FBM_SAMPLES_X;
+    float dy = MAP_HEIGHT / (float)FBM_SAMPLES_Y;
+    int first = x0 * FBM_SAMPLES_X;
+    int count = n * FBM_SAMPLES_X;
+    for (int j = 0; j < FBM_SAMPLES_Y; j++) {
+        float ly = cy * MAP_HEIGHT + (j + 0.5f) * dy;
+        fbm_row(f, dx / 2, dx, first, ly, count, samples[j]);
+        for (int i = 0; i < count; i++)
+            samples[j][i] -= falloff(dx / 2 + (first + i) * dx, ly,
+                                     map->width, map->height);
+    }
+    for (int c = 0; c < n; c++) {
+        int cx = x0 + c;
+        float mean = 0;
+        for (int j = 0; j < FBM_SAMPLES_Y; j++)
+            for (int i = 0; i < FBM_SAMPLES_X; i++)
+                mean += samples[j][c * FBM_SAMPLES_X + i];
+        mean /= FBM_SAMPLES_X * FBM_SAMPLES_Y;
+        float std = 0;
+        for (int j = 0; j < FBM_SAMPLES_Y; j++) {
+            for (int i = 0; i < FBM_SAMPLES_X; i++) {
+                float diff = mean - samples[j][c * FBM_SAMPLES_X + i];
+                std += diff * diff;
+            }
+        }
+        std = sqrt(std / (FBM_SAMPLES_X * FBM_SAMPLES_Y));
+        enum map_base base = classify(mean, std);
+        if (base == BASE_GRASSLAND && fbm_lattice(cx, cy, f->forest) <= -0.2)
+            base = BASE_FOREST;
+        out[c] = base;
+    }
+}
+
+/**
+ * Terrain for MAP's chunk CX, CY.
+ */
+static void
+fbm_chunk(const map_t *map, map_chunk_t *chunk, int cx, int cy)
+{
+    fbm_t f;
+    fbm_init(&f, map->seed);
+    int x0 = cx * CHUNK_WIDTH;
+    int n = map->width - x0 < CHUNK_WIDTH ? map->width - x0 : CHUNK_WIDTH;
+    for (int y = 0; y < chunk->rows; y++) {
+        uint16_t row[CHUNK_WIDTH];
+        fbm_cells(&f, map, cy * CHUNK_HEIGHT + y, x0, n, row);
+        for (int x = 0; x < n; x++)
+            chunk->terrain[y][x] = terrain_of(row[x]);
+    }
+}
+
+/**
+ * An empty world of WIDTH by HEIGHT squares, without any chunks yet.
+ */
+static map_t *
+map_new(uint64_t seed, enum map_engine engine, int width, int height)
+{
+    map_t *map = calloc(sizeof(*map), 1);
+    map->width = width;
+    map->height = height;
+    map->chunks_x = (width + CHUNK_WIDTH - 1) / CHUNK_WIDTH;
+    map->chunks_y = (height + CHUNK_HEIGHT - 1) / CHUNK_HEIGHT;
+    size_t chunks = map->chunks_x * map->chunks_y;
+    map->chunk = calloc(chunks, sizeof(*map->chunk));
+    map->active = malloc(chunks * sizeof(*map->active));
+    map->seed = seed;
+    map->engine = engine;
+    return map;
+}
+
+/**
+ * Make MAP's chunk CX, CY, generating its terrain if it is fBm; a
+ * diamond-square world has all its terrain from the start.
+ */
+static map_chunk_t *
+chunk_make(map_t *map, int cx, int cy)
+{
+    map_chunk_t *chunk = calloc(sizeof(*chunk), 1);
+    int rows = map->height - cy * CHUNK_HEIGHT;
+    chunk->rows = rows < CHUNK_HEIGHT ? rows : CHUNK_HEIGHT;
+    if (map->engine == MAP_FBM)
+        fbm_chunk(map, chunk, cx, cy);
+    return map->chunk[cy * map->chunks_x + cx] = chunk;
+}
+
+/**
+ * MAP's chunk CX, CY, made on the spot if this is the first look at
+ * it.
+ */
+static inline map_chunk_t *
+chunk_get(map_t *map, int cx, int cy)
+{
+    map_chunk_t *chunk = map->chunk[cy * map->chunks_x + cx];
+    return chunk ? chunk : chunk_make(map, cx, cy);
+}
+
+/**
+ * Generate a classic world with ENGINE, showing sketches to WATCH (if
+ * any) where the engine has them. Returns NULL if WATCH abandoned it.
+ */
+static map_t *
+generate(uint64_t seed, enum map_engine engine, watch_fn *watch, void *arg)
+{
+    map_t *map = map_new(seed, engine, MAP_WIDTH, MAP_HEIGHT);
+    switch (engine) {
+    case MAP_DIAMOND_SQUARE:
+        if (!diamond_square(map, seed, watch, arg)) {
+            map_free(map);
+            return NULL;
+        }
+        break;
+    case MAP_FBM:
+        chunk_get(map, 0, 0); // all of it, while nobody is waiting
+        break;
+    }
     return map;
 }
 
+struct sift {
+    int level;
+    map_keep_fn *keep;
+    void *arg;
+};
+
+static bool
+sift_watch(void *arg, int level, uint16_t sketch[MAP_WIDTH][MAP_HEIGHT])
+{
+    struct sift *sift = arg;
+    return level != sift->level || sift->keep(sketch, sift->arg);
+}
+
+/**
+ * Generate the world for SEED with ENGINE unless KEEP, shown a sketch
+ * of it after LEVEL coarse levels, turns it down, in which case the
+ * rest of the work is skipped and NULL is returned. Engines without
+ * coarse levels never consult KEEP.
+ */
+map_t *
+map_generate_if(uint64_t seed, enum map_engine engine, int level,
+                map_keep_fn *keep, void *arg)
+{
+    struct sift sift = {level, keep, arg};
+    return generate(seed, engine, sift_watch, &sift);
+}
+
+map_t *
+map_copy(const map_t *map)
+{
+    map_t *copy = map_new(map->seed, map->engine, map->width, map->height);
+    for (int i = 0; i < map->chunks_x * map->chunks_y; i++) {
+        if (map->chunk[i]) {
+            copy->chunk[i] = malloc(sizeof(*copy->chunk[i]));
+            *copy->chunk[i] = *map->chunk[i];
+        }
+    }
+    memcpy(copy->active, map->active,
+           map->active_count * sizeof(*map->active));
+    copy->active_count = map->active_count;
+    return copy;
+}
+
 void
 map_free(map_t *map)
 {
-    free(map);
+    if (map) {
+        for (int i = 0; i < map->chunks_x * map->chunks_y; i++)
+            free(map->chunk[i]);
+        free(map->chunk);
+        free(map->active);
+        free(map);
+    }
+}
+
+/**
+ * Count the buildings in MAP's chunk INDEX afresh, listing or
+ * unlisting it as active if it has gained its first or lost its last
+ * since it had BEFORE. The list stays in storage order.
+ */
+static void
+chunk_recount(map_t *map, int index, int before)
+{
+    map_chunk_t *chunk = map->chunk[index];
+    chunk->buildings = 0;
+    for (int y = 0; y < chunk->rows; y++)
+        for (int x = 0; x < CHUNK_WIDTH; x++)
+            chunk->buildings += chunk->building[y][x] != C_NONE;
+    if (!before == !chunk->buildings)
+        return;
+    int *active = map->active;
+    int i = 0;
+    while (i < map->active_count && active[i] < index)
+        i++;
+    if (chunk->buildings) {
+        memmove(active + i + 1, active + i,
+                (map->active_count++ - i) * sizeof(*active));
+        active[i] = index;
+    } else {
+        memmove(active + i, active + i + 1,
+                (--map->active_count - i) * sizeof(*active));
+    }
+}
+
+/* A packed chunk is its index then its squares, as they are stored. */
+#define CHUNK_SQUARES offsetof(map_chunk_t, rows)
+#define PACKED_SIZE (sizeof(int32_t) + CHUNK_SQUARES)
+
+/**
+ * Write MAP's active chunks, all there is to a world that its seed
+ * does not say, to OUT, or only size them up if OUT is NULL. Returns
+ * the bytes written.
+ */
+size_t
+map_pack(const map_t *map, uint8_t *out)
+{
+    for (int i = 0; out && i < map->active_count; i++) {
+        int32_t index = map->active[i];
+        memcpy(out, &index, sizeof(index));
+        memcpy(out + sizeof(index), map->chunk[index], CHUNK_SQUARES);
+        out += PACKED_SIZE;
+    }
+    return map->active_count * PACKED_SIZE;
+}
+
+/**
+ * Put back the chunks that map_pack() wrote to the LEN bytes at IN,
+ * clearing the buildings from any others.
+ */
+void
+map_unpack(map_t *map, const uint8_t *in, size_t len)
+{
+    for (int i = 0; i < map->active_count; i++) {
+        map_chunk_t *chunk = map->chunk[map->active[i]];
+        memset(chunk->building, C_NONE, sizeof(chunk->building));
+        memset(chunk->age, 0, sizeof(chunk->age));
+        chunk->buildings = 0;
+    }
+    map->active_count = 0;
+    int chunks = map->chunks_x * map->chunks_y;
+    for (size_t n = 0; n + PACKED_SIZE <= len; n += PACKED_SIZE) {
+        int32_t index;
+        memcpy(&index, in + n, sizeof(index));
+        if (index < 0 || index >= chunks)
+            continue;
+        map_chunk_t *chunk = chunk_get(map, index % map->chunks_x,
+                                       index / map->chunks_x);
+        int before = chunk->buildings;
+        memcpy(chunk, in + n + sizeof(index), CHUNK_SQUARES);
+        chunk_recount(map, index, before);
+    }
 }
 
+/**
+ * Font for BASE at X, Y squares from the middle of the world.
+ */
 static font_t
 base_font(enum map_base base, int x, int y)
 {
@@ -152,8 +735,8 @@ base_font(enum map_base base, int x, int y)
         break;
     case BASE_COAST: {
         font = FONT(w, b);
-        float dx = (x / (float)MAP_WIDTH) - 0.5;
-        float dy = (y / (float)MAP_HEIGHT) - 0.5;
+        float dx = x / (float)MAP_WIDTH;
+        float dy = y / (float)MAP_HEIGHT;
         dx *= 1.3;
         float dist = sqrt(dx * dx + dy * dy) * 100;
         float offset = fmod(device_uepoch() / 500000.0, PI * 2);
@@ -178,51 +761,384 @@ base_font(enum map_base base, int x, int y)
     return font;
 }
 
+/**
+ * Draw as much of MAP's terrain as fits P, with the square at X, Y in
+ * its top left corner. Past the edge of the world is ocean.
+ */
 void
-map_draw_terrain(map_t *map, panel_t *p)
+map_draw_terrain(map_t *map, panel_t *p, int x, int y)
 {
-    for (size_t y = 0; y < MAP_HEIGHT; y++) {
-        for (size_t x = 0; x < MAP_WIDTH; x++) {
-            uint16_t c = map->high[x][y].base;
-            font_t font = base_font(c, x, y);
-            panel_putc(p, x, y, font, c);
+    for (int py = 0; py < p->h; py++) {
+        for (int px = 0; px < p->w; px++) {
+            int mx = x + px;
+            int my = y + py;
+            uint16_t c = map_base(map, mx, my);
+            int cx = mx - CASTLE_X(map);
+            int cy = my - CASTLE_Y(map);
+            panel_putc(p, px, py, base_font(c, cx, cy), c);
         }
     }
 }
 
+/**
+ * Draw the buildings in view as map_draw_terrain() would.
+ */
 void
-map_draw_buildings(map_t *map, panel_t *p)
+map_draw_buildings(map_t *map, panel_t *p, int x, int y)
 {
-    for (size_t y = 0; y < MAP_HEIGHT; y++) {
-        for (size_t x = 0; x < MAP_WIDTH; x++) {
-            enum building building = map->high[x][y].building;
+    for (int py = 0; py < p->h; py++) {
+        for (int px = 0; px < p->w; px++) {
+            enum building building = map_building(map, x + px, y + py);
             if (building != C_NONE) {
                 uint16_t c = building;
                 font_t font = FONT(Y, k);
-                if (map->high[x][y].building_age < 0) {
+                if (map_age(map, x + px, y + py) < 0) {
                     font.fore = COLOR_CYAN;
                     c = tolower(c);
                 }
-                panel_putc(p, x, y, font, c);
+                panel_putc(p, px, py, font, c);
             }
         }
     }
 }
 
 static inline bool
-is_valid_xy(int x, int y)
+is_valid_xy(const map_t *map, int x, int y)
+{
+    return x >= 0 && x < map->width && y >= 0 && y < map->height;
+}
+
+/* Squares are addressed by a chunk, CX, CY, and a square in it, SX,
+ * SY, after is_valid_xy(), so the halves can come from shifts. */
+#define CX(x) ((unsigned)(x) / CHUNK_WIDTH)
+#define CY(y) ((unsigned)(y) / CHUNK_HEIGHT)
+#define SX(x) ((unsigned)(x) % CHUNK_WIDTH)
+#define SY(y) ((unsigned)(y) % CHUNK_HEIGHT)
+
+/**
+ * The chunk holding X, Y, or NULL if nothing has needed it yet, in
+ * which case it has no buildings.
+ */
+static inline map_chunk_t *
+chunk_find(const map_t *map, int x, int y)
 {
-    return x >= 0 && x < MAP_WIDTH && y >= 0 && y < MAP_HEIGHT;
+    return map->chunk[CY(y) * map->chunks_x + CX(x)];
 }
 
 uint16_t
 map_base(map_t *map, int x, int y)
 {
-    return is_valid_xy(x, y) ? map->high[x][y].base : BASE_OCEAN;
+    if (!is_valid_xy(map, x, y))
+        return BASE_OCEAN;
+    map_chunk_t *chunk = chunk_get(map, CX(x), CY(y));
+    return terrain_bases[chunk->terrain[SY(y)][SX(x)]];
 }
 
 uint16_t
 map_building(map_t *map, int x, int y)
 {
-    return is_valid_xy(x, y) ? map->high[x][y].building : C_NONE;
+    if (!is_valid_xy(map, x, y))
+        return C_NONE;
+    map_chunk_t *chunk = chunk_find(map, x, y);
+    return chunk ? chunk->building[SY(y)][SX(x)] : C_NONE;
+}
+
+/**
+ * Seconds since the building at X, Y was finished, negative while it
+ * is still going up. It stops counting some 68 years in.
+ */
+long
+map_age(map_t *map, int x, int y)
+{
+    if (!is_valid_xy(map, x, y))
+        return 0;
+    map_chunk_t *chunk = chunk_find(map, x, y);
+    return chunk ? chunk->age[SY(y)][SX(x)] : 0;
+}
+
+void
+map_set_base(map_t *map, int x, int y, uint16_t base)
+{
+    if (is_valid_xy(map, x, y)) {
+        map_chunk_t *chunk = chunk_get(map, CX(x), CY(y));
+        chunk->terrain[SY(y)][SX(x)] = terrain_of(base);
+    }
+}
+
+void
+map_set_building(map_t *map, int x, int y, uint16_t building)
+{
+    if (is_valid_xy(map, x, y)) {
+        map_chunk_t *chunk = chunk_get(map, CX(x), CY(y));
+        uint8_t *square = &chunk->building[SY(y)][SX(x)];
+        if (*square != building) {
+            *square = building;
+            chunk_recount(map, CY(y) * map->chunks_x + CX(x),
+                          chunk->buildings);
+        }
+    }
+}
+
+void
+map_set_age(map_t *map, int x, int y, long age)
+{
+    if (is_valid_xy(map, x, y)) {
+        map_chunk_t *chunk = chunk_get(map, CX(x), CY(y));
+        chunk->age[SY(y)][SX(x)] =
+            age < INT32_MIN ? INT32_MIN : age > INT32_MAX ? INT32_MAX : age;
+    }
+}
+
+#ifndef _WIN32
+/* Worlds are pre-generated on a single worker thread, one at a time,
+ * so that the work buffers are never held more than once. */
+
+enum job_state {JOB_QUEUED, JOB_RUNNING, JOB_DONE};
+
+struct job {
+    uint64_t seed;
+    enum map_engine engine;
+    enum job_state state;
+    bool discarded; // nobody will collect the map
+    map_t *map;
+    int level; // previews published
+    uint16_t preview[MAP_WIDTH][MAP_HEIGHT];
+    struct job *next;
+};
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond; // a job was queued or finished
+    bool started;
+    job_t *jobs;
+} worker = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, false, 0};
+
+static job_t **
+job_find(uint64_t seed, enum map_engine engine)
+{
+    job_t **j = &worker.jobs;
+    while (*j && ((*j)->seed != seed || (*j)->engine != engine))
+        j = &(*j)->next;
+    return j;
+}
+
+/**
+ * Finish a job, handing the map over to its collector.
+ */
+static void
+job_finish(job_t *job, map_t *map)
+{
+    job->map = map;
+    job->state = JOB_DONE;
+    if (job->discarded) {
+        *job_find(job->seed, job->engine) = job->next;
+        map_free(map);
+        free(job);
+    }
+    pthread_cond_broadcast(&worker.cond);
+}
+
+static bool
+preview_publish(void *arg, int level, uint16_t coarse[MAP_WIDTH][MAP_HEIGHT])
+{
+    job_t *job = arg;
+    pthread_mutex_lock(&worker.lock);
+    memcpy(job->preview, coarse, sizeof(job->preview));
+    job->level = level;
+    pthread_mutex_unlock(&worker.lock);
+    return true;
+}
+
+static void *
+worker_main(void *arg)
+{
+    (void) arg;
+    pthread_mutex_lock(&worker.lock);
+    for (;;) {
+        job_t *job = worker.jobs;
+        while (job && job->state != JOB_QUEUED)
+            job = job->next;
+        if (!job) {
+            pthread_cond_wait(&worker.cond, &worker.lock);
+            continue;
+        }
+        job->state = JOB_RUNNING;
+        pthread_mutex_unlock(&worker.lock);
+        map_t *map = generate(job->seed, job->engine, preview_publish, job);
+        pthread_mutex_lock(&worker.lock);
+        job_finish(job, map);
+    }
+    return NULL;
+}
+
+/**
+ * Start generating the world for SEED and ENGINE in the background, for
+ * a later map_generate() to collect.
+ */
+void
+map_prefetch(uint64_t seed, enum map_engine engine)
+{
+    pthread_mutex_lock(&worker.lock);
+    if (!*job_find(seed, engine)) {
+        if (!worker.started) {
+            pthread_t thread;
+            worker.started = !pthread_create(&thread, NULL, worker_main, NULL);
+            if (worker.started)
+                pthread_detach(thread);
+        }
+        if (worker.started) {
+            job_t *job = calloc(sizeof(*job), 1);
+            job->seed = seed;
+            job->engine = engine;
+            *job_find(seed, engine) = job; // appends
+            pthread_cond_broadcast(&worker.cond);
+        }
+    }
+    pthread_mutex_unlock(&worker.lock);
+}
+
+/**
+ * Give up on a prefetched world that will not be needed.
+ */
+void
+map_discard(uint64_t seed, enum map_engine engine)
+{
+    pthread_mutex_lock(&worker.lock);
+    job_t **j = job_find(seed, engine);
+    job_t *job = *j;
+    if (job && job->state == JOB_RUNNING) {
+        job->discarded = true;
+    } else if (job) {
+        *j = job->next;
+        map_free(job->map);
+        free(job);
+    }
+    pthread_mutex_unlock(&worker.lock);
+}
+
+/**
+ * Generate the classic world for SEED with ENGINE. A prefetched world
+ * is collected, waiting for the worker only if it is still busy with
+ * it.
+ */
+static map_t *
+collect(uint64_t seed, enum map_engine engine)
+{
+    map_t *map = NULL;
+    pthread_mutex_lock(&worker.lock);
+    job_t **j = job_find(seed, engine);
+    job_t *job = *j;
+    if (job && job->state == JOB_QUEUED) {
+        job->state = JOB_RUNNING; // not started yet, so run it here
+        pthread_mutex_unlock(&worker.lock);
+        map = generate(seed, engine, NULL, NULL);
+        pthread_mutex_lock(&worker.lock);
+        job_finish(job, map);
+    }
+    if (job) {
+        while (job->state != JOB_DONE)
+            pthread_cond_wait(&worker.cond, &worker.lock);
+        *job_find(seed, engine) = job->next;
+        map = job->map;
+        free(job);
+    }
+    pthread_mutex_unlock(&worker.lock);
+    return map ? map : generate(seed, engine, NULL, NULL);
+}
+
+/**
+ * True if map_generate() has SEED's world ready, or would generate it
+ * on the spot, rather than wait for the worker.
+ */
+bool
+map_ready(uint64_t seed, enum map_engine engine)
+{
+    pthread_mutex_lock(&worker.lock);
+    job_t *job = *job_find(seed, engine);
+    bool ready = !job || job->state == JOB_DONE;
+    pthread_mutex_unlock(&worker.lock);
+    return ready;
+}
+
+/**
+ * Draw what there is so far of the world being prefetched for SEED.
+ * Returns false, drawing nothing, if there is none yet.
+ */
+bool
+map_preview(uint64_t seed, enum map_engine engine, panel_t *p)
+{
+    uint16_t bases[MAP_WIDTH][MAP_HEIGHT];
+    map_t *map = NULL;
+    int level = 0;
+    pthread_mutex_lock(&worker.lock);
+    job_t *job = *job_find(seed, engine);
+    if (job && job->state == JOB_DONE)
+        map = job->map; // safe, only its collector frees it
+    else if (job && (level = job->level))
+        memcpy(bases, job->preview, sizeof(bases));
+    pthread_mutex_unlock(&worker.lock);
+    if (map) {
+        map_draw_terrain(map, p, 0, 0);
+    } else if (level) {
+        for (size_t y = 0; y < MAP_HEIGHT; y++)
+            for (size_t x = 0; x < MAP_WIDTH; x++)
+                panel_putc(p, x, y, base_font(bases[x][y], x - MAP_WIDTH / 2,
+                                              y - MAP_HEIGHT / 2),
+                           bases[x][y]);
+    }
+    return map || level;
+}
+#else
+void
+map_prefetch(uint64_t seed, enum map_engine engine)
+{
+    (void) seed; // no worker thread here, worlds generate on demand
+    (void) engine;
+}
+
+void
+map_discard(uint64_t seed, enum map_engine engine)
+{
+    (void) seed;
+    (void) engine;
+}
+
+static map_t *
+collect(uint64_t seed, enum map_engine engine)
+{
+    return generate(seed, engine, NULL, NULL);
+}
+
+bool
+map_ready(uint64_t seed, enum map_engine engine)
+{
+    (void) seed;
+    (void) engine;
+    return true;
+}
+
+bool
+map_preview(uint64_t seed, enum map_engine engine, panel_t *p)
+{
+    (void) seed;
+    (void) engine;
+    (void) p;
+    return false;
+}
+#endif
+
+/**
+ * Generate the world for SEED with ENGINE, WIDTH by HEIGHT squares.
+ * Diamond-square worlds are always classic. Only a classic world is
+ * ever prefetched; a larger one starts out with no chunks at all and
+ * makes them as play reaches them.
+ */
+map_t *
+map_generate(uint64_t seed, enum map_engine engine, int width, int height)
+{
+    if (engine == MAP_DIAMOND_SQUARE ||
+        (width == MAP_WIDTH && height == MAP_HEIGHT))
+        return collect(seed, engine);
+    map_discard(seed, engine);
+    return map_new(seed, engine, width, height);
 }
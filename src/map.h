@@ -2,10 +2,17 @@
 
 #include "display.h"
 
+/* The classic world, which is also as much of a world as the screen
+ * shows at once. Larger worlds are multiples of it, up to MAP_MAX. */
 #define MAP_WIDTH  60
 #define MAP_HEIGHT 24
-#define CASTLE_X (MAP_WIDTH / 2)
-#define CASTLE_Y (MAP_HEIGHT / 2)
+#define MAP_MAX    4096
+#define CASTLE_X(map) ((map)->width / 2)
+#define CASTLE_Y(map) ((map)->height / 2)
+
+/* Squares are stored a chunk at a time, and a classic world is one. */
+#define CHUNK_WIDTH  64
+#define CHUNK_HEIGHT 32
 
 enum map_base {
     BASE_OCEAN = ' ',
@@ -30,22 +37,67 @@ enum building {
     C_FARM = 'F'
 };
 
+/* How a world's terrain is made from its seed. */
+enum map_engine {
+    MAP_DIAMOND_SQUARE, // the original, and all that older saves knew
+    MAP_FBM
+};
+
+/* Terrain as a map stores it, one byte a square. */
+enum map_terrain {
+    TERRAIN_OCEAN,
+    TERRAIN_COAST,
+    TERRAIN_SAND,
+    TERRAIN_GRASSLAND,
+    TERRAIN_FOREST,
+    TERRAIN_HILL,
+    TERRAIN_MOUNTAIN
+};
+
+/* A chunk's squares are parallel arrays, row by row, so that scans over
+ * them are contiguous. Outside of scans, go through map_base(),
+ * map_building() and map_age() and their setters. */
+typedef struct map_chunk {
+    uint8_t terrain[CHUNK_HEIGHT][CHUNK_WIDTH];  // enum map_terrain
+    uint8_t building[CHUNK_HEIGHT][CHUNK_WIDTH]; // enum building
+    int32_t age[CHUNK_HEIGHT][CHUNK_WIDTH];      // see map_age()
+    int rows;      // of the above inside the world
+    int buildings; // squares with one
+} map_chunk_t;
+
+/* Chunks are made the first time anything looks at them, and those
+ * with buildings are listed, in storage order, in ACTIVE. */
 typedef struct map {
-    struct {
-        uint16_t base;
-        uint16_t building;
-        long building_age;
-    } high[MAP_WIDTH][MAP_HEIGHT];
-    struct {
-        float height;
-    } low[MAP_WIDTH * MAP_WIDTH][MAP_HEIGHT * MAP_HEIGHT];
+    int width, height; // in squares
+    int chunks_x, chunks_y;
+    map_chunk_t **chunk; // row by row, NULL until needed
+    int *active, active_count;
+    uint64_t seed;
+    enum map_engine engine;
 } map_t;
 
-map_t *map_generate(uint64_t seed);
+/* Judges from a rough sketch of a world whether it is worth finishing. */
+typedef bool map_keep_fn(uint16_t sketch[MAP_WIDTH][MAP_HEIGHT], void *);
+
+map_t *map_generate(uint64_t seed, enum map_engine, int width, int height);
+map_t *map_generate_if(uint64_t seed, enum map_engine, int level,
+                       map_keep_fn *, void *);
+void   map_prefetch(uint64_t seed, enum map_engine);
+void   map_discard(uint64_t seed, enum map_engine);
+bool   map_ready(uint64_t seed, enum map_engine);
+bool   map_preview(uint64_t seed, enum map_engine, panel_t *);
+map_t *map_copy(const map_t *);
 void   map_free(map_t *map);
 
-void   map_draw_terrain(map_t *, panel_t *);
-void   map_draw_buildings(map_t *, panel_t *);
+size_t map_pack(const map_t *, uint8_t *);
+void   map_unpack(map_t *, const uint8_t *, size_t);
+
+void   map_draw_terrain(map_t *, panel_t *, int x, int y);
+void   map_draw_buildings(map_t *, panel_t *, int x, int y);
 
 uint16_t map_base(map_t *, int x, int y);
 uint16_t map_building(map_t *, int x, int y);
+long     map_age(map_t *, int x, int y);
+void     map_set_base(map_t *, int x, int y, uint16_t base);
+void     map_set_building(map_t *, int x, int y, uint16_t building);
+void     map_set_age(map_t *, int x, int y, long age);
@@ -1,11 +1,12 @@
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
+#include <stdbool.h>
 #include "rand.h"
 
 #define MIN(x, y) ((y) < (x) ? (y) : (x))
 
-uint64_t rand_state = 0;
+__thread uint64_t rand_state = 0; // per thread, see engine.h
 
 uint64_t
 xorshift(uint64_t *state) {
@@ -44,11 +45,26 @@ rand_uniform(float min, float max)
 
 }
 
+/**
+ * Lemire's multiply-shift reduction of the top 32 bits of X to
+ * [0, RANGE). Returns false for the few X that would bias it.
+ */
+static inline bool
+reduce(uint64_t x, uint32_t range, uint32_t threshold, uint32_t *out)
+{
+    uint64_t m = (x >> 32) * range;
+    *out = m >> 32;
+    return (uint32_t)m >= threshold;
+}
+
 int
 rand_range_s(uint64_t *state, int min, int max)
 {
-    uint64_t x = xorshift(state);
-    return (x % (max - min)) + min;
+    uint32_t range = max - min;
+    uint32_t threshold = range ? -range % range : 0;
+    uint32_t r;
+    while (!reduce(xorshift(state), range, threshold, &r));
+    return min + (int)r;
 }
 
 int
@@ -83,3 +99,97 @@ rand_name(char *name, size_t max)
     }
     name[length] = '\0';
 }
+
+static uint64_t
+splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += UINT64_C(0x9e3779b97f4a7c15));
+    z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return z ^ (z >> 31);
+}
+
+void
+xoshiro_seed(xoshiro_t *x, uint64_t seed)
+{
+    for (int i = 0; i < XOSHIRO_LANES; i++)
+        for (int j = 0; j < 4; j++)
+            x->s[j][i] = splitmix64(&seed);
+}
+
+/**
+ * Advance every lane once. Lanes are independent, so the compiler can
+ * run them side by side in vector registers.
+ */
+static inline void
+xoshiro_round(uint64_t s[4][XOSHIRO_LANES], uint64_t out[XOSHIRO_LANES])
+{
+    for (int i = 0; i < XOSHIRO_LANES; i++) {
+        uint64_t t = s[1][i] << 17;
+        out[i] = s[0][i] + s[3][i];
+        s[2][i] ^= s[0][i];
+        s[3][i] ^= s[1][i];
+        s[1][i] ^= s[2][i];
+        s[0][i] ^= s[3][i];
+        s[2][i] ^= t;
+        s[3][i] = (s[3][i] << 45) | (s[3][i] >> 19);
+    }
+}
+
+/**
+ * Fill OUT with N raw 32-bit draws, for callers that cut their own
+ * small dice from them: the low then the high half of each lane's
+ * output in turn. Cut with shifts rather than copied, so the draws do
+ * not depend on byte order.
+ */
+void
+xoshiro_fill(xoshiro_t *x, uint32_t *out, size_t n)
+{
+    xoshiro_t s = *x;
+    uint64_t r[XOSHIRO_LANES];
+    for (size_t i = 0; i < n; i += 2 * XOSHIRO_LANES) {
+        xoshiro_round(s.s, r);
+        size_t len = MIN(n - i, 2 * XOSHIRO_LANES);
+        for (size_t j = 0; j < len; j++)
+            out[i + j] = r[j / 2] >> (j % 2 * 32);
+    }
+    *x = s;
+}
+
+void
+xoshiro_uniform(xoshiro_t *x, float *out, size_t n, float min, float max)
+{
+    xoshiro_t s = *x; // kept in registers
+    uint64_t r[XOSHIRO_LANES];
+    float scale = (max - min) * 0x1p-24f;
+    for (size_t i = 0; i < n; i += XOSHIRO_LANES) {
+        xoshiro_round(s.s, r);
+        size_t len = MIN(n - i, XOSHIRO_LANES);
+        for (size_t j = 0; j < len; j++)
+            out[i + j] = (int32_t)(r[j] >> 40) * scale + min;
+    }
+    *x = s;
+}
+
+/**
+ * Fill OUT with integers in [MIN, MAX), free of modulo bias. Rejected
+ * draws are skipped, so the lane an output came from is not fixed, but
+ * the sequence still depends only on the seed.
+ */
+void
+xoshiro_range(xoshiro_t *x, int *out, size_t n, int min, int max)
+{
+    xoshiro_t s = *x;
+    uint64_t r[XOSHIRO_LANES];
+    uint32_t range = max - min;
+    uint32_t threshold = range ? -range % range : 0;
+    for (size_t i = 0; i < n;) {
+        xoshiro_round(s.s, r);
+        for (int j = 0; j < XOSHIRO_LANES && i < n; j++) {
+            uint32_t v;
+            if (reduce(r[j], range, threshold, &v))
+                out[i++] = min + (int)v;
+        }
+    }
+    *x = s;
+}
@@ -1,12 +1,13 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 #define countof(a) (sizeof(a) / sizeof(0[a]))
 
 #define PI 3.141592653589793
 
-extern uint64_t rand_state;
+extern __thread uint64_t rand_state;
 
 uint64_t xorshift(uint64_t *state);
 void     xorshift_fill(uint64_t *state, void *, size_t);
@@ -18,3 +19,21 @@ int rand_range_s(uint64_t *state, int min, int max);
 int rand_range(int min, int max);
 
 void rand_name(char *name, size_t max);
+
+#define XOSHIRO_LANES 8
+
+/**
+ * Eight interleaved xoshiro256+ generators, for filling arrays a whole
+ * vector at a time. Output i of a call comes from lane i % 8, and each
+ * call uses up whole rounds of all lanes, discarding the remainder. A
+ * seed therefore gives the same numbers, in the same order, for the
+ * same sequence of calls on any machine or vector width.
+ */
+typedef struct {
+    uint64_t s[4][XOSHIRO_LANES];
+} xoshiro_t;
+
+void xoshiro_seed(xoshiro_t *, uint64_t seed);
+void xoshiro_fill(xoshiro_t *, uint32_t *, size_t n);
+void xoshiro_uniform(xoshiro_t *, float *, size_t n, float min, float max);
+void xoshiro_range(xoshiro_t *, int *, size_t n, int min, int max);
@@ -0,0 +1,479 @@
+#include <stdlib.h>
+#include <string.h>
+#include "record.h"
+#include "display.h"
+#include "utf.h"
+
+#define RECORD_MAGIC "GCOMREC1"
+#define INDEX_MAGIC  "GCOMIDX1"
+#define HEADER_SIZE  10 // magic, width, height
+#define FOOTER_SIZE  16 // index offset, magic
+
+#define KEYFRAME_INTERVAL 10000 // msec between keyframes
+#define CELLS (DISPLAY_WIDTH * DISPLAY_HEIGHT)
+#define FRAME_MAX (CELLS * 5 + 16) // largest frame payload
+
+/* Record types */
+#define TYPE_KEYFRAME 'K'
+#define TYPE_DIFF     'D'
+#define TYPE_INDEX    'I'
+
+typedef struct {
+    uint16_t c;
+    uint8_t font;
+} cell_t;
+
+typedef struct {
+    uint64_t time;   // msec
+    uint64_t offset; // of the record in the file
+} keyframe_t;
+
+struct record {
+    FILE *file;
+    uint64_t start; // usec of the first frame
+    uint64_t time;  // msec of the last frame
+    uint64_t keyframe_time;
+    cell_t screen[CELLS];
+    bool dirty[CELLS];
+    bool changed;
+    keyframe_t *index;
+    size_t index_len, index_cap;
+    uint8_t frame[FRAME_MAX];
+};
+
+struct replay {
+    FILE *file;
+    uint64_t time; // msec of the last applied frame
+    uint64_t duration;
+    uint64_t end;  // offset just past the last frame
+    cell_t screen[CELLS];
+    bool dirty[CELLS]; // cells changed by the last frame
+    keyframe_t *index;
+    size_t index_len;
+    uint8_t frame[FRAME_MAX];
+};
+
+static inline uint8_t
+font_pack(font_t font)
+{
+    return font.fore | font.back << 3 |
+        font.fore_bright << 6 | font.back_bright << 7;
+}
+
+static inline font_t
+font_unpack(uint8_t b)
+{
+    return (font_t){b & 7, b >> 3 & 7, b >> 6 & 1, b >> 7};
+}
+
+static uint8_t *
+varint_put(uint8_t *p, uint64_t v)
+{
+    for (; v >= 0x80; v >>= 7)
+        *p++ = v | 0x80;
+    *p++ = v;
+    return p;
+}
+
+/**
+ * Decode a varint from [*P, END). Returns false if it runs off the end.
+ */
+static bool
+varint_get(const uint8_t **p, const uint8_t *end, uint64_t *v)
+{
+    *v = 0;
+    for (int shift = 0; *p < end && shift < 64; shift += 7) {
+        uint8_t b = *(*p)++;
+        *v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static bool
+varint_read(FILE *in, uint64_t *v)
+{
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int b = fgetc(in);
+        if (b == EOF)
+            return false;
+        *v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static void
+record_write(record_t *r, int type, const uint8_t *payload, size_t len)
+{
+    uint8_t head[16];
+    head[0] = type;
+    uint8_t *p = varint_put(head + 1, len);
+    fwrite(head, p - head, 1, r->file);
+    fwrite(payload, len, 1, r->file);
+}
+
+record_t *
+record_create(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return NULL;
+    record_t *r = calloc(sizeof(*r), 1);
+    r->file = file;
+    for (int i = 0; i < CELLS; i++)
+        r->screen[i] = (cell_t){' ', font_pack(FONT_DEFAULT)};
+    uint8_t header[HEADER_SIZE] = RECORD_MAGIC;
+    header[8] = DISPLAY_WIDTH;
+    header[9] = DISPLAY_HEIGHT;
+    fwrite(header, sizeof(header), 1, file);
+    return r;
+}
+
+/**
+ * Finish the recording with its keyframe index.
+ */
+void
+record_close(record_t *r)
+{
+    if (!r)
+        return;
+    uint64_t offset = ftell(r->file);
+    size_t len = 20 + r->index_len * 20;
+    uint8_t *payload = malloc(len);
+    uint8_t *p = varint_put(payload, r->time);
+    p = varint_put(p, r->index_len);
+    for (size_t i = 0; i < r->index_len; i++) {
+        p = varint_put(p, r->index[i].time);
+        p = varint_put(p, r->index[i].offset);
+    }
+    record_write(r, TYPE_INDEX, payload, p - payload);
+    free(payload);
+    uint8_t footer[FOOTER_SIZE];
+    for (int i = 0; i < 8; i++)
+        footer[i] = offset >> (i * 8);
+    memcpy(footer + 8, INDEX_MAGIC, 8);
+    fwrite(footer, sizeof(footer), 1, r->file);
+    fclose(r->file);
+    free(r->index);
+    free(r);
+}
+
+void
+record_cell(record_t *r, int x, int y, font_t font, uint16_t c)
+{
+    int i = y * DISPLAY_WIDTH + x;
+    cell_t cell = {c ? c : ' ', font_pack(font)};
+    if (r->screen[i].c != cell.c || r->screen[i].font != cell.font) {
+        r->screen[i] = cell;
+        r->dirty[i] = true;
+        r->changed = true;
+    }
+}
+
+static uint8_t *
+encode_cells(uint8_t *p, const cell_t *cells, int count)
+{
+    for (int i = 0; i < count; i++) {
+        *p++ = cells[i].font;
+        p = varint_put(p, cells[i].c);
+    }
+    return p;
+}
+
+/**
+ * End the frame shown at time USEC (device_uepoch()), writing the
+ * cells changed since the last one.
+ */
+void
+record_frame(record_t *r, uint64_t usec)
+{
+    if (!r->changed)
+        return;
+    if (!r->index_len)
+        r->start = usec;
+    r->time = (usec - r->start) / 1000;
+    uint8_t *p = varint_put(r->frame, r->time);
+    if (!r->index_len || r->time - r->keyframe_time >= KEYFRAME_INTERVAL) {
+        p = varint_put(p, 0);
+        p = varint_put(p, CELLS);
+        p = encode_cells(p, r->screen, CELLS);
+        if (r->index_len == r->index_cap) {
+            r->index_cap = r->index_cap ? r->index_cap * 2 : 64;
+            r->index = realloc(r->index, r->index_cap * sizeof(*r->index));
+        }
+        r->index[r->index_len++] = (keyframe_t){r->time, ftell(r->file)};
+        r->keyframe_time = r->time;
+        record_write(r, TYPE_KEYFRAME, r->frame, p - r->frame);
+        fflush(r->file); // a crash loses at most one interval
+    } else {
+        int last = 0;
+        for (int i = 0; i < CELLS; i++) {
+            if (!r->dirty[i])
+                continue;
+            int run = i;
+            while (run < CELLS && r->dirty[run])
+                run++;
+            p = varint_put(p, i - last);
+            p = varint_put(p, run - i);
+            p = encode_cells(p, r->screen + i, run - i);
+            i = last = run;
+        }
+        record_write(r, TYPE_DIFF, r->frame, p - r->frame);
+    }
+    memset(r->dirty, 0, sizeof(r->dirty));
+    r->changed = false;
+}
+
+/* Replay */
+
+/**
+ * Read the record header at the current position.
+ */
+static bool
+replay_header(replay_t *r, int *type, uint64_t *len)
+{
+    *type = fgetc(r->file);
+    return *type != EOF && varint_read(r->file, len);
+}
+
+static bool
+replay_load_index(replay_t *r)
+{
+    uint8_t footer[FOOTER_SIZE];
+    if (fseek(r->file, -FOOTER_SIZE, SEEK_END) ||
+        !fread(footer, sizeof(footer), 1, r->file) ||
+        memcmp(footer + 8, INDEX_MAGIC, 8))
+        return false;
+    uint64_t size = ftell(r->file);
+    uint64_t offset = 0;
+    for (int i = 0; i < 8; i++)
+        offset |= (uint64_t)footer[i] << (i * 8);
+    int type;
+    uint64_t len;
+    if (fseek(r->file, offset, SEEK_SET) ||
+        !replay_header(r, &type, &len) || type != TYPE_INDEX ||
+        offset + len > size)
+        return false;
+    uint8_t *payload = malloc(len ? len : 1);
+    bool ok = len && fread(payload, len, 1, r->file);
+    const uint8_t *p = payload, *end = payload + len;
+    uint64_t count;
+    ok = ok && varint_get(&p, end, &r->duration) &&
+        varint_get(&p, end, &count) && count <= len;
+    if (ok) {
+        r->index = malloc(count * sizeof(*r->index));
+        for (r->index_len = 0; ok && r->index_len < count; r->index_len++) {
+            keyframe_t *k = r->index + r->index_len;
+            ok = varint_get(&p, end, &k->time) &&
+                varint_get(&p, end, &k->offset);
+        }
+    }
+    free(payload);
+    r->end = offset;
+    return ok;
+}
+
+/**
+ * Rebuild the index of a recording that was never closed, skipping
+ * over everything but the keyframes' timestamps.
+ */
+static void
+replay_scan_index(replay_t *r)
+{
+    size_t cap = 0;
+    free(r->index);
+    r->index = NULL;
+    r->index_len = 0;
+    r->end = HEADER_SIZE;
+    fseek(r->file, HEADER_SIZE, SEEK_SET);
+    for (;;) {
+        int type;
+        uint64_t len, time;
+        long start = ftell(r->file);
+        if (!replay_header(r, &type, &len))
+            break;
+        long payload = ftell(r->file);
+        long next = payload + len;
+        if (!len || fseek(r->file, next - 1, SEEK_SET) ||
+            fgetc(r->file) == EOF)
+            break; // truncated
+        fseek(r->file, payload, SEEK_SET);
+        if (!varint_read(r->file, &time))
+            break;
+        if (type == TYPE_KEYFRAME) {
+            if (r->index_len == cap) {
+                cap = cap ? cap * 2 : 64;
+                r->index = realloc(r->index, cap * sizeof(*r->index));
+            }
+            r->index[r->index_len++] = (keyframe_t){time, start};
+        } else if (type != TYPE_DIFF) {
+            break;
+        }
+        fseek(r->file, next, SEEK_SET);
+        r->duration = time;
+        r->end = next;
+    }
+}
+
+replay_t *
+replay_open(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+    uint8_t header[HEADER_SIZE];
+    if (!fread(header, sizeof(header), 1, file) ||
+        memcmp(header, RECORD_MAGIC, 8) ||
+        header[8] != DISPLAY_WIDTH || header[9] != DISPLAY_HEIGHT) {
+        fclose(file);
+        return NULL;
+    }
+    replay_t *r = calloc(sizeof(*r), 1);
+    r->file = file;
+    if (!replay_load_index(r))
+        replay_scan_index(r);
+    replay_seek(r, 0);
+    return r;
+}
+
+void
+replay_close(replay_t *r)
+{
+    fclose(r->file);
+    free(r->index);
+    free(r);
+}
+
+uint64_t
+replay_duration(replay_t *r)
+{
+    return r->duration;
+}
+
+uint64_t
+replay_time(replay_t *r)
+{
+    return r->time;
+}
+
+/**
+ * Apply the next frame if it is due by LIMIT (msec). Otherwise, or
+ * at the end of the recording, the position is left unchanged.
+ */
+bool
+replay_next(replay_t *r, uint64_t limit)
+{
+    long start = ftell(r->file);
+    int type;
+    uint64_t len, time;
+    if ((uint64_t)start >= r->end || !replay_header(r, &type, &len) ||
+        len > FRAME_MAX || !fread(r->frame, len, 1, r->file)) {
+        fseek(r->file, start, SEEK_SET);
+        return false;
+    }
+    const uint8_t *p = r->frame, *end = r->frame + len;
+    if (!varint_get(&p, end, &time) || time > limit) {
+        fseek(r->file, start, SEEK_SET);
+        return false;
+    }
+    memset(r->dirty, 0, sizeof(r->dirty));
+    uint64_t i = 0, skip, count;
+    while (p < end && varint_get(&p, end, &skip) &&
+           varint_get(&p, end, &count)) {
+        for (i += skip; count-- && i < CELLS && p < end; i++) {
+            uint64_t c;
+            uint8_t font = *p++;
+            if (!varint_get(&p, end, &c))
+                break;
+            r->screen[i] = (cell_t){c, font};
+            r->dirty[i] = true;
+        }
+    }
+    r->time = time;
+    return true;
+}
+
+/**
+ * Show the screen as it was at MSEC, decoding forward from the
+ * nearest keyframe before it.
+ */
+void
+replay_seek(replay_t *r, uint64_t msec)
+{
+    size_t lo = 0, hi = r->index_len;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (r->index[mid].time <= msec)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    for (int i = 0; i < CELLS; i++)
+        r->screen[i] = (cell_t){' ', font_pack(FONT_DEFAULT)};
+    r->time = 0;
+    fseek(r->file, r->index_len ? r->index[lo].offset : HEADER_SIZE,
+          SEEK_SET);
+    replay_next(r, UINT64_MAX); // the keyframe itself
+    while (replay_next(r, msec));
+}
+
+uint16_t
+replay_cell(replay_t *r, int x, int y, font_t *font)
+{
+    cell_t cell = r->screen[y * DISPLAY_WIDTH + x];
+    *font = font_unpack(cell.font);
+    return cell.c;
+}
+
+static void
+export_cell(FILE *out, cell_t cell, int *last)
+{
+    if (cell.font != *last) {
+        font_t f = font_unpack(cell.font);
+        fprintf(out, "\e[%d;%dm", f.fore + 30 + (f.fore_bright ? 60 : 0),
+                f.back + 40 + (f.back_bright ? 60 : 0));
+        *last = cell.font;
+    }
+    uint8_t utf8[7];
+    fwrite(utf8, utf32_to_8(cell.c, utf8), 1, out);
+}
+
+/**
+ * Write the current screen as ANSI text. With STREAM, every later
+ * frame follows as cursor-addressed updates, without timing.
+ */
+void
+replay_export(replay_t *r, FILE *out, bool stream)
+{
+    int last = -1;
+    if (stream)
+        fputs("\e[2J", out);
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        if (stream)
+            fprintf(out, "\e[%d;1H", y + 1);
+        for (int x = 0; x < DISPLAY_WIDTH; x++)
+            export_cell(out, r->screen[y * DISPLAY_WIDTH + x], &last);
+        if (!stream) {
+            fputs("\e[m\n", out);
+            last = -1;
+        }
+    }
+    while (stream && replay_next(r, UINT64_MAX)) {
+        int next = -1;
+        for (int i = 0; i < CELLS; i++) {
+            if (!r->dirty[i])
+                continue;
+            if (i != next || i % DISPLAY_WIDTH == 0)
+                fprintf(out, "\e[%d;%dH",
+                        i / DISPLAY_WIDTH + 1, i % DISPLAY_WIDTH + 1);
+            export_cell(out, r->screen[i], &last);
+            next = i + 1;
+        }
+    }
+    if (stream)
+        fprintf(out, "\e[m\e[%d;1H", DISPLAY_HEIGHT + 1);
+}
@@ -0,0 +1,29 @@
+/**
+ * Session recordings. The recorder is fed the cells the display
+ * changes each frame and writes them as timestamped diffs, with a
+ * full keyframe every few seconds and a keyframe index at the end, so
+ * a replay can seek anywhere by decoding from the nearest keyframe.
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "device.h"
+
+typedef struct record record_t;
+typedef struct replay replay_t;
+
+record_t *record_create(const char *path);
+void      record_close(record_t *);
+void      record_cell(record_t *, int x, int y, font_t, uint16_t c);
+void      record_frame(record_t *, uint64_t usec);
+
+replay_t *replay_open(const char *path);
+void      replay_close(replay_t *);
+uint64_t  replay_duration(replay_t *);
+uint64_t  replay_time(replay_t *);
+bool      replay_next(replay_t *, uint64_t limit);
+void      replay_seek(replay_t *, uint64_t msec);
+uint16_t  replay_cell(replay_t *, int x, int y, font_t *);
+void      replay_export(replay_t *, FILE *, bool stream);
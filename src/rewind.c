@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "rewind.h"
+#include "rand.h"
+
+/* A snapshot is the game, the random state and its map's packed
+ * chunks, so snapshots grow and shrink as the map does. Past its
+ * length, a snapshot's buffer is kept zeroed, and snapshots of
+ * different lengths are compared as if padded with zeros. */
+#define HEAD_SIZE (sizeof(game_t) + sizeof(rand_state))
+
+typedef struct {
+    size_t len, cap;
+    uint8_t *data;
+} snapshot_t;
+
+typedef struct {
+    long time;
+    size_t size; // of the snapshot it leads to
+    size_t len;
+    uint8_t *data;
+} delta_t;
+
+struct rewind {
+    size_t budget;
+    size_t used; // bytes of delta data
+    bool empty;
+    long base_time;
+    unsigned head, count; // ring of deltas following the base
+    delta_t deltas[REWIND_MAX];
+    snapshot_t base;
+    snapshot_t last; // newest checkpoint, diffed against
+    snapshot_t next;
+    snapshot_t encoded;
+};
+
+static uint8_t *
+varint_put(uint8_t *p, size_t v)
+{
+    for (; v >= 0x80; v >>= 7)
+        *p++ = v | 0x80;
+    *p++ = v;
+    return p;
+}
+
+static const uint8_t *
+varint_get(const uint8_t *p, size_t *v)
+{
+    *v = 0;
+    for (int shift = 0;; shift += 7) {
+        *v |= (size_t)(*p & 0x7f) << shift;
+        if (!(*p++ & 0x80))
+            return p;
+    }
+}
+
+/**
+ * Make room in S for LEN bytes, zeroed past its length.
+ */
+static void
+snapshot_reserve(snapshot_t *s, size_t len)
+{
+    if (len > s->cap) {
+        size_t cap = len > s->cap * 2 ? len : s->cap * 2;
+        s->data = realloc(s->data, cap);
+        memset(s->data + s->cap, 0, cap - s->cap);
+        s->cap = cap;
+    }
+}
+
+/**
+ * Make S LEN bytes long, zeroing anything it drops.
+ */
+static void
+snapshot_resize(snapshot_t *s, size_t len)
+{
+    snapshot_reserve(s, len);
+    if (len < s->len)
+        memset(s->data + len, 0, s->len - len);
+    s->len = len;
+}
+
+static void
+snapshot_copy(snapshot_t *dst, const snapshot_t *src)
+{
+    snapshot_resize(dst, src->len);
+    memcpy(dst->data, src->data, src->len);
+}
+
+static void
+snapshot_save(snapshot_t *s, game_t *game)
+{
+    snapshot_resize(s, HEAD_SIZE + map_pack(game->map, NULL));
+    memcpy(s->data, game, sizeof(*game));
+    memcpy(s->data + sizeof(*game), &rand_state, sizeof(rand_state));
+    map_pack(game->map, s->data + HEAD_SIZE);
+}
+
+/**
+ * Load a snapshot into GAME, keeping its map and the speed the player
+ * has chosen.
+ */
+static void
+snapshot_load(const snapshot_t *s, game_t *game)
+{
+    map_t *map = game->map;
+    int speed = game->speed;
+    memcpy(game, s->data, sizeof(*game));
+    game->map = map;
+    game->speed = speed;
+    memcpy(&rand_state, s->data + sizeof(*game), sizeof(rand_state));
+    map_unpack(map, s->data + HEAD_SIZE, s->len - HEAD_SIZE);
+}
+
+/**
+ * Encode the XOR of two snapshots into OUT as runs of (unchanged
+ * count, changed count, changed bytes). Returns the encoded length.
+ */
+static size_t
+delta_encode(snapshot_t *out, snapshot_t *a, snapshot_t *b)
+{
+    size_t n = a->len > b->len ? a->len : b->len;
+    snapshot_reserve(a, n);
+    snapshot_reserve(b, n);
+    snapshot_reserve(out, n * 2 + 16); // worst case
+    uint8_t *p = out->data;
+    size_t i = 0;
+    while (i < n) {
+        size_t start = i;
+        while (i < n && a->data[i] == b->data[i])
+            i++;
+        p = varint_put(p, i - start);
+        start = i;
+        while (i < n && a->data[i] != b->data[i])
+            i++;
+        p = varint_put(p, i - start);
+        for (size_t k = start; k < i; k++)
+            *p++ = a->data[k] ^ b->data[k];
+    }
+    return p - out->data;
+}
+
+static void
+delta_apply(snapshot_t *s, const delta_t *d)
+{
+    snapshot_reserve(s, d->size);
+    const uint8_t *p = d->data;
+    const uint8_t *end = p + d->len;
+    size_t i = 0;
+    while (p < end) {
+        size_t skip, count;
+        p = varint_get(p, &skip);
+        p = varint_get(p, &count);
+        for (i += skip; count; count--)
+            s->data[i++] ^= *p++;
+    }
+    s->len = d->size;
+}
+
+rewind_t *
+rewind_create(size_t budget)
+{
+    rewind_t *r = calloc(sizeof(*r), 1);
+    r->budget = budget;
+    r->empty = true;
+    return r;
+}
+
+void
+rewind_free(rewind_t *r)
+{
+    for (unsigned i = 0; i < r->count; i++)
+        free(r->deltas[(r->head + i) % REWIND_MAX].data);
+    free(r->base.data);
+    free(r->last.data);
+    free(r->next.data);
+    free(r->encoded.data);
+    free(r);
+}
+
+/**
+ * Merge the oldest delta into the base.
+ */
+static void
+rewind_fold(rewind_t *r)
+{
+    delta_t *d = r->deltas + r->head;
+    delta_apply(&r->base, d);
+    r->base_time = d->time;
+    r->used -= d->len;
+    free(d->data);
+    r->head = (r->head + 1) % REWIND_MAX;
+    r->count--;
+}
+
+static long
+rewind_newest(rewind_t *r)
+{
+    if (!r->count)
+        return r->base_time;
+    return r->deltas[(r->head + r->count - 1) % REWIND_MAX].time;
+}
+
+/**
+ * Add a checkpoint of GAME, unless one at or after its time is kept.
+ */
+void
+rewind_push(rewind_t *r, game_t *game)
+{
+    if (r->empty) {
+        snapshot_save(&r->base, game);
+        snapshot_copy(&r->last, &r->base);
+        r->base_time = game->time;
+        r->empty = false;
+        return;
+    }
+    if (game->time <= rewind_newest(r))
+        return;
+    if (r->count == REWIND_MAX)
+        rewind_fold(r);
+    snapshot_save(&r->next, game);
+    delta_t *d = r->deltas + (r->head + r->count++) % REWIND_MAX;
+    d->time = game->time;
+    d->size = r->next.len;
+    d->len = delta_encode(&r->encoded, &r->last, &r->next);
+    d->data = malloc(d->len);
+    memcpy(d->data, r->encoded.data, d->len);
+    snapshot_copy(&r->last, &r->next);
+    r->used += d->len;
+    while (r->used > r->budget && r->count > 1)
+        rewind_fold(r);
+}
+
+/**
+ * Restore GAME to the newest checkpoint at or before TIME, or the
+ * oldest one kept. Later checkpoints are dropped, as the game goes on
+ * from there. Returns false if there are none.
+ */
+bool
+rewind_restore(rewind_t *r, game_t *game, long time)
+{
+    if (r->empty)
+        return false;
+    snapshot_copy(&r->next, &r->base);
+    unsigned keep = 0;
+    for (; keep < r->count; keep++) {
+        delta_t *d = r->deltas + (r->head + keep) % REWIND_MAX;
+        if (d->time > time)
+            break;
+        delta_apply(&r->next, d);
+    }
+    for (unsigned i = keep; i < r->count; i++) {
+        delta_t *d = r->deltas + (r->head + i) % REWIND_MAX;
+        r->used -= d->len;
+        free(d->data);
+    }
+    r->count = keep;
+    snapshot_copy(&r->last, &r->next);
+    snapshot_load(&r->next, game);
+    return true;
+}
+
+/**
+ * Bytes of memory held by the timeline.
+ */
+size_t
+rewind_size(rewind_t *r)
+{
+    return sizeof(*r) + r->used + r->base.cap + r->last.cap + r->next.cap +
+        r->encoded.cap;
+}
@@ -0,0 +1,24 @@
+/**
+ * Rewind timeline. Checkpoints of the game state are kept as one full
+ * base snapshot followed by run-length encoded XOR deltas, each
+ * against the checkpoint before it. When the ring is full or over its
+ * memory budget, the oldest delta is folded into the base, so any
+ * restore costs one copy plus at most REWIND_MAX deltas.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "game.h"
+
+#define REWIND_MAX    240              // checkpoints, 10 days at one per hour
+#define REWIND_BUDGET (4L * 1024 * 1024) // bytes of deltas kept
+
+typedef struct rewind rewind_t;
+
+rewind_t *rewind_create(size_t budget);
+void      rewind_free(rewind_t *);
+
+void      rewind_push(rewind_t *, game_t *);
+bool      rewind_restore(rewind_t *, game_t *, long time);
+size_t    rewind_size(rewind_t *);
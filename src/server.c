@@ -0,0 +1,469 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/signalfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "server.h"
+#include "device_unix.h"
+#include "display.h"
+#include "engine.h"
+
+#define STACK_SIZE (1024 * 1024)
+#define SESSIONS_MAX 1024
+#define NEGOTIATE_TIMEOUT 500000 // usec to wait for a window size
+#define OUTPUT_MAX (1024 * 1024) // drop clients this far behind
+
+/* Telnet protocol (RFC 854, 1073, 1091) */
+#define IAC  255
+#define DONT 254
+#define DO   253
+#define WONT 252
+#define WILL 251
+#define SB   250
+#define SE   240
+#define OPT_ECHO  1
+#define OPT_SGA   3
+#define OPT_TTYPE 24
+#define OPT_NAWS  31
+#define TTYPE_IS   0
+#define TTYPE_SEND 1
+
+enum telnet_state { T_DATA, T_CR, T_IAC, T_OPTION, T_SB, T_SB_IAC };
+
+typedef struct session {
+    int fd;
+    bool started, done;
+    ucontext_t context;
+    void *stack;
+    terminal_t term;
+    engine_t engine;
+    /* What play() holds on the heap, freed here if the client drops
+     * and leaves it suspended, never to return through its cleanup. */
+    game_t *game;
+    rewind_t *timeline;
+    bool world;             // a prefetched world awaits collection
+    uint64_t world_seed;
+    enum map_engine world_engine;
+    uint64_t wake;    // resume at this time, 0 for never
+    uint64_t tick_at; // resume at this frame tick, 0 for never
+    bool ticked;
+    bool input;       // bytes arrived since the session last ran
+    bool naws;        // window size known
+    uint64_t start;   // give up on negotiation at this time
+    struct {
+        enum telnet_state state;
+        int verb;
+        uint8_t sb[64];
+        size_t sb_len;
+        char ttype[32];
+    } telnet;
+} session_t;
+
+static struct {
+    ucontext_t main;
+    session_t *current;
+    void (*entry)(void);
+    session_t *sessions[SESSIONS_MAX];
+    int count;
+} server;
+
+static void
+telnet_send(session_t *s, const uint8_t *bytes, size_t len)
+{
+    terminal_write(&s->term, bytes, len);
+}
+
+static void
+telnet_emit(session_t *s, uint8_t c)
+{
+    uint8_t *p;
+    if (input_space(&s->term.input, &p) > 0) {
+        *p = c;
+        input_commit(&s->term.input, 1);
+        s->term.read_time = device_now();
+        s->input = true;
+    }
+}
+
+static void
+telnet_option(session_t *s, int verb, int option)
+{
+    switch (option) {
+    case OPT_ECHO:
+    case OPT_SGA:
+        return; // acknowledgements of our offers
+    case OPT_NAWS:
+        if (verb == WONT)
+            s->naws = true; // start now with the default size
+        return;
+    case OPT_TTYPE:
+        if (verb == WILL) {
+            uint8_t send[] = {IAC, SB, OPT_TTYPE, TTYPE_SEND, IAC, SE};
+            telnet_send(s, send, sizeof(send));
+        }
+        return;
+    }
+    /* Refuse everything else. */
+    if (verb == WILL || verb == DO) {
+        uint8_t refuse[] = {IAC, verb == WILL ? DONT : WONT, option};
+        telnet_send(s, refuse, sizeof(refuse));
+    }
+}
+
+static void
+telnet_subnegotiation(session_t *s)
+{
+    uint8_t *sb = s->telnet.sb;
+    size_t len = s->telnet.sb_len;
+    if (len >= 5 && sb[0] == OPT_NAWS) {
+        int width = sb[1] << 8 | sb[2];
+        int height = sb[3] << 8 | sb[4];
+        if (width > 0 && height > 0) {
+            s->term.width = width;
+            s->term.height = height;
+            s->term.resized = s->started;
+        }
+        s->naws = true;
+    } else if (len >= 2 && sb[0] == OPT_TTYPE && sb[1] == TTYPE_IS) {
+        size_t n = len - 2;
+        if (n >= sizeof(s->telnet.ttype))
+            n = sizeof(s->telnet.ttype) - 1;
+        memcpy(s->telnet.ttype, sb + 2, n);
+        s->telnet.ttype[n] = '\0';
+    }
+}
+
+static void
+telnet_byte(session_t *s, uint8_t c)
+{
+    switch (s->telnet.state) {
+    case T_CR:
+        s->telnet.state = T_DATA;
+        if (c == '\n' || c == '\0')
+            break; // CR LF and CR NUL are both just enter
+        /* Fallthrough */
+    case T_DATA:
+        if (c == IAC) {
+            s->telnet.state = T_IAC;
+        } else {
+            telnet_emit(s, c);
+            if (c == '\r')
+                s->telnet.state = T_CR;
+        }
+        break;
+    case T_IAC:
+        s->telnet.state = T_DATA;
+        if (c >= WILL && c <= DONT) {
+            s->telnet.verb = c;
+            s->telnet.state = T_OPTION;
+        } else if (c == SB) {
+            s->telnet.sb_len = 0;
+            s->telnet.state = T_SB;
+        } else if (c == IAC) {
+            telnet_emit(s, c);
+        }
+        break;
+    case T_OPTION:
+        telnet_option(s, s->telnet.verb, c);
+        s->telnet.state = T_DATA;
+        break;
+    case T_SB:
+        if (c == IAC)
+            s->telnet.state = T_SB_IAC;
+        else if (s->telnet.sb_len < sizeof(s->telnet.sb))
+            s->telnet.sb[s->telnet.sb_len++] = c;
+        break;
+    case T_SB_IAC:
+        if (c == SE) {
+            telnet_subnegotiation(s);
+            s->telnet.state = T_DATA;
+        } else {
+            if (c == IAC && s->telnet.sb_len < sizeof(s->telnet.sb))
+                s->telnet.sb[s->telnet.sb_len++] = c;
+            s->telnet.state = T_SB;
+        }
+        break;
+    }
+}
+
+/* Called from inside the session's coroutine. */
+static bool
+session_wait(terminal_t *t, uint64_t wake, bool tick)
+{
+    session_t *s = t->arg;
+    uint64_t now = device_now();
+    s->wake = wake;
+    s->tick_at = tick ? now / t->period * t->period + t->period : 0;
+    s->ticked = false;
+    s->input = false;
+    swapcontext(&s->context, &server.main);
+    return s->ticked;
+}
+
+static void
+session_entry(void)
+{
+    session_t *s = server.current;
+    server.entry();
+    s->done = true;
+}
+
+static session_t *
+session_create(int fd)
+{
+    session_t *s = calloc(sizeof(*s), 1);
+    s->fd = fd;
+    s->stack = mmap(NULL, STACK_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (s->stack == MAP_FAILED) {
+        free(s);
+        return NULL;
+    }
+    terminal_init(&s->term, fd, fd);
+    s->term.wait = session_wait;
+    s->term.arg = s;
+    s->engine.display = display_create();
+    s->engine.terminal = &s->term;
+    device_entropy(&s->engine.rand_state, sizeof(s->engine.rand_state));
+    s->start = device_now() + NEGOTIATE_TIMEOUT;
+    uint8_t hello[] = {
+        IAC, WILL, OPT_ECHO,
+        IAC, WILL, OPT_SGA,
+        IAC, DO, OPT_SGA,
+        IAC, DO, OPT_NAWS,
+        IAC, DO, OPT_TTYPE,
+    };
+    telnet_send(s, hello, sizeof(hello));
+    terminal_flush(&s->term);
+    return s;
+}
+
+static void
+session_destroy(session_t *s)
+{
+    if (s->game)
+        game_free(s->game);
+    if (s->timeline)
+        rewind_free(s->timeline);
+    if (s->world)
+        map_discard(s->world_seed, s->world_engine);
+    terminal_flush(&s->term);
+    terminal_free(&s->term);
+    display_destroy(s->engine.display);
+    munmap(s->stack, STACK_SIZE);
+    close(s->fd);
+    free(s);
+}
+
+static void
+session_resume(session_t *s)
+{
+    if (!s->started) {
+        getcontext(&s->context);
+        s->context.uc_stack.ss_sp = s->stack;
+        s->context.uc_stack.ss_size = STACK_SIZE;
+        s->context.uc_link = &server.main;
+        makecontext(&s->context, session_entry, 0);
+        s->started = true;
+    }
+    engine_swap(&s->engine);
+    server.current = s;
+    swapcontext(&server.main, &s->context);
+    server.current = NULL;
+    engine_swap(&s->engine);
+    terminal_flush(&s->term);
+}
+
+/**
+ * Returns true if the session should run now.
+ */
+static bool
+session_ready(session_t *s, uint64_t now)
+{
+    if (!s->started)
+        return s->naws || now >= s->start;
+    if (s->tick_at && now >= s->tick_at)
+        s->ticked = true;
+    return s->input || s->ticked || (s->wake && now >= s->wake) ||
+        (s->tick_at && s->term.resized);
+}
+
+static uint64_t
+session_wake(session_t *s)
+{
+    if (!s->started)
+        return s->start;
+    uint64_t wake = s->wake;
+    if (s->tick_at && (!wake || s->tick_at < wake))
+        wake = s->tick_at;
+    return wake;
+}
+
+/* Returns false if the connection is gone. */
+static bool
+session_read(session_t *s)
+{
+    uint8_t buf[INPUT_RING];
+    ssize_t r = read(s->fd, buf, sizeof(buf));
+    if (r == 0 || (r < 0 && errno != EAGAIN && errno != EINTR))
+        return false;
+    for (ssize_t i = 0; i < r; i++)
+        telnet_byte(s, buf[i]);
+    return true;
+}
+
+int
+server_listen(int port)
+{
+    int fd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    int yes = 1, no = 0;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &no, sizeof(no));
+    struct sockaddr_in6 addr = {
+        .sin6_family = AF_INET6,
+        .sin6_port = htons(port),
+        .sin6_addr = IN6ADDR_ANY_INIT
+    };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(fd, 64) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void
+server_accept(int listener)
+{
+    int fd;
+    while ((fd = accept4(listener, NULL, NULL,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+        session_t *s = NULL;
+        if (server.count < SESSIONS_MAX)
+            s = session_create(fd);
+        if (!s) {
+            close(fd);
+            continue;
+        }
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        server.sessions[server.count++] = s;
+    }
+}
+
+int
+server_run(int port, void (*session)(void))
+{
+    int listener = server_listen(port);
+    if (listener < 0) {
+        perror("gcom: listen");
+        return EXIT_FAILURE;
+    }
+    server.entry = session;
+    signal(SIGPIPE, SIG_IGN);
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+    int sigfd = signalfd(-1, &mask, SFD_CLOEXEC);
+
+    static struct pollfd fds[SESSIONS_MAX + 2];
+    bool running = true;
+    while (running) {
+        uint64_t now = device_now();
+        uint64_t wake = 0;
+        fds[0] = (struct pollfd){listener, POLLIN, 0};
+        fds[1] = (struct pollfd){sigfd, POLLIN, 0};
+        for (int i = 0; i < server.count; i++) {
+            session_t *s = server.sessions[i];
+            short events = POLLIN;
+            if (s->term.output_len)
+                events |= POLLOUT;
+            fds[i + 2] = (struct pollfd){s->fd, events, 0};
+            uint64_t w = session_wake(s);
+            if (w && (!wake || w < wake))
+                wake = w;
+        }
+        int timeout = -1;
+        if (wake)
+            timeout = wake > now ? (wake - now + 999) / 1000 : 0;
+        if (poll(fds, server.count + 2, timeout) < 0 && errno != EINTR)
+            break;
+
+        if (fds[1].revents)
+            running = false;
+        int count = server.count;
+        for (int i = 0; i < count; i++) {
+            session_t *s = server.sessions[i];
+            short revents = fds[i + 2].revents;
+            if (revents & (POLLIN | POLLHUP | POLLERR))
+                if (!session_read(s))
+                    s->done = true;
+            if (revents & POLLOUT)
+                terminal_flush(&s->term);
+        }
+        now = device_now();
+        for (int i = 0; i < count; i++) {
+            session_t *s = server.sessions[i];
+            if (!s->done && session_ready(s, now))
+                session_resume(s);
+            if (s->term.hangup || s->term.output_len > OUTPUT_MAX)
+                s->done = true;
+        }
+        for (int i = 0; i < server.count; i++) {
+            if (server.sessions[i]->done) {
+                session_destroy(server.sessions[i]);
+                server.sessions[i--] = server.sessions[--server.count];
+            }
+        }
+        if (fds[0].revents)
+            server_accept(listener);
+    }
+
+    while (server.count)
+        session_destroy(server.sessions[--server.count]);
+    close(sigfd);
+    close(listener);
+    return 0;
+}
+
+void
+server_session_game(game_t *game)
+{
+    if (server.current)
+        server.current->game = game;
+}
+
+void
+server_session_timeline(rewind_t *timeline)
+{
+    if (server.current)
+        server.current->timeline = timeline;
+}
+
+/**
+ * Note that the world for SEED and ENGINE was prefetched, or with
+ * WAITING false, that it has been collected or discarded.
+ */
+void
+server_session_world(uint64_t seed, enum map_engine engine, bool waiting)
+{
+    session_t *s = server.current;
+    if (s) {
+        s->world = waiting;
+        s->world_seed = seed;
+        s->world_engine = engine;
+    }
+}
@@ -0,0 +1,17 @@
+/**
+ * Multi-session telnet server. Every connection plays its own game in
+ * a coroutine, all multiplexed by one poll() loop in one thread.
+ */
+#pragma once
+
+#include "game.h"
+#include "rewind.h"
+
+int  server_listen(int port);
+int  server_run(int port, void (*session)(void));
+
+/* Hand the session what play() holds, to free should the client drop
+ * mid-game, and NULL or false once play() has let go of it. */
+void server_session_game(game_t *);
+void server_session_timeline(rewind_t *);
+void server_session_world(uint64_t seed, enum map_engine, bool waiting);
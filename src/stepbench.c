@@ -0,0 +1,124 @@
+/**
+ * Checks batch_step() against game_step() and measures both. A few
+ * worlds are built up and played for a while, then cloned into N lanes
+ * with their own random states, and every lane is stepped both ways
+ * and compared with game_hash().
+ *
+ *   stepbench [STEPS]
+ *
+ * STEPS is the total game steps per batch size, split across lanes.
+ * Rates are per CPU second.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "game.h"
+#include "batch.h"
+#include "rand.h"
+
+#define WORLDS 4
+
+static const char order[] = "HFWMHFSH+H";
+
+static double
+now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * A world with buildings of every age and invaders about.
+ */
+static game_t *
+world(int w)
+{
+    rand_state = w + 1;
+    game_t *game = game_create(xorshift(&rand_state), MAP_DIAMOND_SQUARE,
+                                MAP_WIDTH, MAP_HEIGHT);
+    const char *building = order;
+    for (int hour = 0; hour < 72; hour++) {
+        for (int r = 2; r < MAP_WIDTH && *building; r++) {
+            int x = CASTLE_X(game->map) + rand_range(-r, r);
+            int y = CASTLE_Y(game->map) + rand_range(-r / 2, r / 2);
+            if (game_build(game, *building, x, y)) {
+                building++;
+                break;
+            }
+        }
+        if (!*building)
+            building = order;
+        for (int s = 0; s < HOUR; s++)
+            game_step(game);
+        while (game_event_pop(game) != EVENT_NONE);
+    }
+    return game;
+}
+
+static game_t *
+clone(const game_t *game)
+{
+    game_t *copy = malloc(sizeof(*copy));
+    *copy = *game;
+    copy->map = map_copy(game->map);
+    return copy;
+}
+
+static void
+bench(game_t **worlds, size_t lanes, long total)
+{
+    long steps = total / lanes;
+    batch_t *batch = batch_create(lanes);
+    game_t **games = malloc(lanes * sizeof(*games));
+    uint64_t *rands = malloc(lanes * sizeof(*rands));
+    for (size_t i = 0; i < lanes; i++) {
+        games[i] = clone(worlds[i % WORLDS]);
+        rands[i] = i * UINT64_C(0x9e3779b97f4a7c15) + 1;
+        batch_load(batch, i, games[i], rands[i]);
+    }
+
+    double start = now();
+    for (size_t i = 0; i < lanes; i++) {
+        rand_state = rands[i];
+        for (long s = 0; s < steps; s++)
+            game_step(games[i]);
+        rands[i] = rand_state;
+    }
+    double single = now() - start;
+
+    start = now();
+    for (long s = 0; s < steps; s++)
+        batch_step(batch);
+    double batched = now() - start;
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < lanes; i++)
+        if (game_hash(games[i]) != game_hash(batch_game(batch, i)))
+            mismatches++;
+
+    double n = (double)steps * lanes;
+    printf("%6zu %8ld %12.0f %12.0f %8.1fx %6zu\n", lanes, steps,
+           n / single, n / batched, single / batched, mismatches);
+    for (size_t i = 0; i < lanes; i++)
+        game_free(games[i]);
+    free(games);
+    free(rands);
+    batch_free(batch);
+}
+
+int
+main(int argc, char **argv)
+{
+    long total = argc > 1 ? atol(argv[1]) : 1L << 22;
+    game_t *worlds[WORLDS];
+    for (int w = 0; w < WORLDS; w++)
+        worlds[w] = world(w);
+    printf(" lanes    steps  game_step/s  batch_step/s  speedup  wrong\n");
+    size_t sizes[] = {1, 64, 4096};
+    for (unsigned i = 0; i < countof(sizes); i++)
+        bench(worlds, sizes[i], total);
+    return 0;
+}
@@ -0,0 +1,198 @@
+/**
+ * Text page compiler. Reads pages written with panel_printf() colour
+ * directives and writes them out as C source, each page a text_t named
+ * after its file (doc/game-over.txt becomes text_game_over), with its
+ * glyphs decoded and split into runs of one font, line by line.
+ *
+ *   textc OUTPUT PAGE...
+ *
+ * A page ends at a line starting with '@'. A percent sign is written
+ * "%%", as in a panel_printf() format.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "display.h"
+#include "utf.h"
+
+#define LINE_MAX 1024
+#define NEST_MAX 16 // as in panel_printf()
+
+typedef struct {
+    int lines;
+    int runs, glyphs;
+    uint16_t *line;
+    struct text_run *run;
+    uint16_t *glyph;
+} page_t;
+
+static const char *output;
+
+static void
+fail(const char *path, int lineno, const char *message)
+{
+    fprintf(stderr, "%s:%d: %s\n", path, lineno, message);
+    remove(output);
+    exit(EXIT_FAILURE);
+}
+
+static void *
+grow(void *p, int count, size_t size)
+{
+    if (count & (count - 1))
+        return p; // only at powers of two
+    p = realloc(p, (count ? count * 2 : 1) * size);
+    if (!p) {
+        fprintf(stderr, "textc: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static void
+page_glyph(page_t *page, font_t font, uint16_t c)
+{
+    struct text_run *run;
+    if (page->runs == page->line[page->lines] || // a new line
+        !font_equal(page->run[page->runs - 1].font, font)) {
+        page->run = grow(page->run, page->runs, sizeof(*page->run));
+        run = page->run + page->runs++;
+        run->font = font;
+        run->start = page->glyphs;
+        run->length = 0;
+    } else {
+        run = page->run + page->runs - 1;
+    }
+    page->glyph = grow(page->glyph, page->glyphs, sizeof(*page->glyph));
+    page->glyph[page->glyphs++] = c;
+    run->length++;
+}
+
+/**
+ * Compile one line the way panel_printf() draws a format.
+ */
+static void
+page_line(page_t *page, const char *path, int lineno, const char *s)
+{
+    page->line = grow(page->line, page->lines, sizeof(*page->line));
+    page->line[page->lines] = page->runs;
+    int f = 0;
+    font_t font[NEST_MAX] = {FONT_DEFAULT};
+    int nest = 0;
+    for (; *s; s += utf8_charlen((uint8_t)*s)) {
+        uint32_t c;
+        if (is_color_directive(s)) {
+            if (++f == NEST_MAX)
+                fail(path, lineno, "directives nested too deeply");
+            font[f] = font_decode(s);
+            s += 2;
+            continue;
+        } else if (*s == '}' && (nest > 0 || f > 0)) {
+            if (nest == 0) {
+                f--;
+                continue;
+            }
+            nest--;
+            c = '}';
+        } else if (*s == '{') {
+            nest++;
+            continue;
+        } else if (*s == '%') {
+            if (s[1] != '%')
+                fail(path, lineno, "lone '%', write it as \"%%\"");
+            c = *s++;
+        } else {
+            if (!utf8_valid((uint8_t *)s))
+                fail(path, lineno, "invalid UTF-8");
+            c = utf8_to_32((uint8_t *)s);
+            if (c > UINT16_MAX)
+                fail(path, lineno, "character outside the BMP");
+        }
+        page_glyph(page, font[f], c);
+    }
+    page->lines++;
+    if (page->runs > UINT16_MAX || page->glyphs > UINT16_MAX)
+        fail(path, lineno, "page too long");
+}
+
+static void
+page_write(FILE *out, const page_t *page, const char *name)
+{
+    fprintf(out, "\nstatic const uint16_t %s_line[] = {", name);
+    for (int i = 0; i <= page->lines; i++)
+        fprintf(out, "%s%d,", i % 12 ? " " : "\n    ",
+                i < page->lines ? page->line[i] : page->runs);
+    fprintf(out, "\n};\n\nstatic const struct text_run %s_runs[] = {",
+            name);
+    for (int i = 0; i < page->runs; i++) {
+        const struct text_run *r = page->run + i;
+        fprintf(out, "\n    {{%d, %d, %d, %d}, %d, %d},",
+                r->font.fore, r->font.back,
+                r->font.fore_bright, r->font.back_bright,
+                r->start, r->length);
+    }
+    fprintf(out, "\n};\n\nstatic const uint16_t %s_glyphs[] = {", name);
+    for (int i = 0; i < page->glyphs; i++)
+        fprintf(out, "%s%d,", i % 12 ? " " : "\n    ", page->glyph[i]);
+    fprintf(out, "\n};\n\nconst text_t text_%s = {\n"
+            "    %d, %s_line, %s_runs, %s_glyphs\n};\n",
+            name, page->lines, name, name, name);
+}
+
+int
+main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s OUTPUT PAGE...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    output = argv[1];
+    FILE *out = fopen(output, "w");
+    if (!out) {
+        perror(output);
+        return EXIT_FAILURE;
+    }
+    fprintf(out, "/* Compiled by textc; do not edit. */\n"
+            "#include \"src/display.h\"\n");
+    for (int i = 2; i < argc; i++) {
+        const char *path = argv[i];
+        FILE *in = fopen(path, "r");
+        if (!in) {
+            perror(path);
+            remove(output);
+            return EXIT_FAILURE;
+        }
+        page_t page = {0};
+        char line[LINE_MAX];
+        int lineno = 1;
+        for (; fgets(line, sizeof(line), in) && line[0] != '@'; lineno++) {
+            size_t length = strcspn(line, "\r\n");
+            if (!line[length] && !feof(in))
+                fail(path, lineno, "line too long");
+            line[length] = '\0';
+            page_line(&page, path, lineno, line);
+        }
+        if (feof(in))
+            fail(path, lineno, "no '@' line to end the page");
+        fclose(in);
+
+        const char *base = strrchr(path, '/');
+        char name[256];
+        snprintf(name, sizeof(name), "%s", base ? base + 1 : path);
+        name[strcspn(name, ".")] = '\0';
+        for (char *c = name; *c; c++)
+            if (!isalnum((unsigned char)*c))
+                *c = '_';
+        page_write(out, &page, name);
+        free(page.line);
+        free(page.run);
+        free(page.glyph);
+    }
+    if (fclose(out)) {
+        perror(output);
+        remove(output);
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
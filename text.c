@@ -0,0 +1,1193 @@
+/* Compiled by textc; do not edit. */
+#include "src/display.h"
+
+static const uint16_t story_line[] = {
+    0, 2, 2, 3, 4, 5, 6, 11, 12, 13, 13, 16,
+    19, 20, 20, 23, 24, 27, 28, 29, 30,
+};
+
+static const struct text_run story_runs[] = {
+    {{7, 0, 1, 0}, 0, 32},
+    {{6, 0, 1, 0}, 32, 10},
+    {{7, 0, 1, 0}, 42, 60},
+    {{7, 0, 1, 0}, 102, 60},
+    {{7, 0, 1, 0}, 162, 60},
+    {{7, 0, 1, 0}, 222, 60},
+    {{7, 0, 1, 0}, 282, 9},
+    {{3, 0, 1, 0}, 291, 8},
+    {{7, 0, 1, 0}, 299, 17},
+    {{1, 0, 1, 0}, 316, 6},
+    {{7, 0, 1, 0}, 322, 20},
+    {{7, 0, 1, 0}, 342, 60},
+    {{7, 0, 1, 0}, 402, 26},
+    {{7, 0, 1, 0}, 428, 31},
+    {{1, 0, 1, 0}, 459, 6},
+    {{7, 0, 1, 0}, 465, 23},
+    {{7, 0, 1, 0}, 488, 47},
+    {{3, 0, 1, 0}, 535, 8},
+    {{7, 0, 1, 0}, 543, 5},
+    {{7, 0, 1, 0}, 548, 13},
+    {{7, 0, 1, 0}, 561, 30},
+    {{6, 0, 1, 0}, 591, 10},
+    {{7, 0, 1, 0}, 601, 20},
+    {{7, 0, 1, 0}, 621, 60},
+    {{7, 0, 1, 0}, 681, 27},
+    {{6, 0, 1, 0}, 708, 10},
+    {{7, 0, 1, 0}, 718, 23},
+    {{7, 0, 1, 0}, 741, 60},
+    {{7, 0, 1, 0}, 801, 60},
+    {{7, 0, 1, 0}, 861, 13},
+};
+
+static const uint16_t story_glyphs[] = {
+    32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32,
+    32, 32, 32, 32, 32, 32, 84, 104, 101, 32, 79, 114,
+    105, 103, 105, 110, 32, 111, 102, 32, 71, 111, 98, 108,
+    105, 110, 45, 67, 79, 77, 32, 32, 89, 111, 117, 32,
+    32, 97, 114, 101, 32, 116, 104, 101, 32, 32, 114, 117,
+    108, 101, 114, 32, 111, 102, 32, 32, 97, 32, 102, 108,
+    101, 100, 103, 108, 105, 110, 103, 44, 32, 32, 121, 111,
+    117, 110, 103, 44, 32, 104, 117, 109, 97, 110, 32, 32,
+    105, 115, 108, 97, 110, 100, 110, 97, 116, 105, 111, 110,
+    46, 32, 65, 32, 32, 102, 101, 119, 32, 109, 111, 110,
+    116, 104, 115, 32, 97, 103, 111, 44, 32, 32, 97, 32,
+    114, 111, 103, 117, 101, 32, 105, 108, 108, 101, 103, 97,
+    108, 108, 121, 32, 32, 101, 120, 112, 108, 111, 114, 105,
+    110, 103, 32, 116, 104, 101, 100, 117, 110, 103, 101, 111,
+    110, 115, 32, 32, 32, 97, 110, 100, 32, 32, 99, 97,
+    118, 101, 115, 32, 32, 32, 117, 110, 100, 101, 114, 110,
+    101, 97, 116, 104, 32, 32, 121, 111, 117, 114, 32, 32,
+    32, 99, 97, 115, 116, 108, 101, 32, 32, 117, 110, 101,
+    97, 114, 116, 104, 101, 100, 115, 111, 109, 101, 116, 104,
+    105, 110, 103, 32, 32, 105, 110, 116, 101, 114, 101, 115,
+    116, 105, 110, 103, 32, 32, 97, 110, 100, 32, 32, 116,
+    101, 114, 114, 105, 98, 108, 101, 46, 32, 32, 73, 116,
+    32, 32, 119, 97, 115, 32, 32, 97, 110, 32, 32, 97,
+    110, 99, 105, 101, 110, 116, 111, 98, 115, 105, 100, 105,
+    97, 110, 32, 102, 105, 103, 117, 114, 105, 110, 101, 32,
+    32, 111, 102, 32, 97, 32, 32, 109, 101, 110, 97, 99,
+    105, 110, 103, 32, 103, 111, 98, 108, 105, 110, 46, 32,
+    84, 104, 101, 32, 32, 99, 97, 115, 116, 108, 101, 32,
+    119, 105, 122, 97, 114, 100, 119, 97, 114, 110, 101, 100,
+    32, 32, 116, 104, 97, 116, 32, 32, 105, 116, 32, 112,
+    117, 108, 115, 101, 100, 32, 32, 119, 105, 116, 104, 32,
+    32, 100, 97, 114, 107, 32, 32, 101, 110, 101, 114, 103,
+    121, 32, 108, 105, 107, 101, 32, 32, 97, 32, 32, 98,
+    101, 97, 99, 111, 110, 46, 84, 114, 111, 117, 98, 108,
+    101, 32, 119, 111, 117, 108, 100, 32, 115, 111, 111, 110,
+    32, 102, 111, 108, 108, 111, 119, 46, 32, 32, 87, 105,
+    116, 104, 105, 110, 32, 32, 97, 32, 109, 97, 116, 116,
+    101, 114, 32, 32, 111, 102, 32, 32, 119, 101, 101, 107,
+    115, 44, 32, 103, 111, 98, 108, 105, 110, 32, 32, 114,
+    97, 105, 100, 115, 32, 32, 111, 110, 32, 116, 104, 101,
+    32, 32, 105, 115, 108, 97, 110, 100, 115, 117, 100, 100,
+    101, 110, 108, 121, 32, 32, 105, 110, 99, 114, 101, 97,
+    115, 101, 100, 46, 32, 32, 77, 97, 110, 121, 32, 32,
+    119, 101, 114, 101, 32, 32, 107, 105, 108, 101, 100, 46,
+    32, 32, 84, 104, 101, 32, 32, 102, 105, 103, 117, 114,
+    105, 110, 101, 32, 32, 119, 97, 115, 99, 97, 108, 108,
+    105, 110, 103, 32, 116, 104, 101, 109, 46, 32, 32, 84,
+    111, 32, 100, 101, 97, 108, 32, 32, 119, 105, 116, 104,
+    32, 116, 104, 105, 115, 32, 32, 116, 104, 114, 101, 97,
+    116, 44, 32, 71, 111, 98, 108, 105, 110, 45, 67, 79,
+    77, 44, 32, 116, 104, 101, 32, 32, 71, 111, 98, 108,
+    105, 110, 32, 67, 111, 109, 98, 97, 116, 85, 110, 105,
+    116, 32, 119, 97, 115, 32, 99, 114, 101, 97, 116, 101,
+    100, 46, 32, 73, 116, 32, 119, 97, 115, 32, 109, 97,
+    100, 101, 32, 32, 117, 112, 32, 111, 102, 32, 116, 104,
+    101, 32, 103, 114, 101, 97, 116, 101, 115, 116, 32, 104,
+    101, 114, 111, 101, 115, 32, 116, 104, 101, 105, 115, 108,
+    97, 110, 100, 32, 104, 97, 100, 32, 116, 111, 32, 111,
+    102, 102, 101, 114, 46, 32, 87, 104, 105, 108, 101, 32,
+    71, 111, 98, 108, 105, 110, 45, 67, 79, 77, 32, 102,
+    101, 110, 100, 115, 32, 111, 102, 102, 32, 116, 104, 101,
+    32, 103, 111, 98, 108, 105, 110, 115, 44, 121, 111, 117,
+    32, 32, 109, 117, 115, 116, 32, 32, 102, 105, 103, 117,
+    114, 101, 32, 32, 111, 117, 116, 32, 32, 104, 111, 119,
+    32, 32, 116, 111, 32, 32, 100, 101, 97, 108, 32, 32,
+    119, 105, 116, 104, 32, 32, 116, 104, 101, 32, 32, 109,
+    121, 115, 116, 101, 114, 105, 111, 117, 115, 102, 105, 103,
+    117, 114, 105, 110, 101, 46, 32, 80, 101, 114, 104, 97,
+    112, 115, 32, 105, 116, 32, 99, 97, 110, 32, 98, 101,
+    32, 100, 101, 115, 116, 114, 111, 121, 101, 100, 44, 32,
+    98, 117, 116, 32, 116, 104, 101, 32, 119, 105, 122, 97,
+    114, 100, 115, 32, 100, 111, 110, 39, 116, 121, 101, 116,
+    32, 107, 110, 111, 119, 32, 104, 111, 119, 46,
+};
+
+const text_t text_story = {
+    20, story_line, story_runs, story_glyphs
+};
+
+static const uint16_t help_line[] = {
+    0, 3, 3, 6, 7, 8, 9, 9, 12, 12, 15, 17,
+    18, 19, 20, 20, 21, 24, 25, 30, 33, 34, 35, 35,
+    36, 37, 39, 39, 42, 42, 45, 48, 49, 50, 50, 55,
+    56, 61, 63, 66, 66, 69, 70, 71, 71, 74, 75, 76,
+    76, 77, 78, 83, 84, 84, 85, 86, 87,
+};
+
+static const struct text_run help_runs[] = {
+    {{7, 0, 1, 0}, 0, 24},
+    {{2, 0, 1, 0}, 24, 11},
+    {{7, 0, 1, 0}, 35, 25},
+    {{7, 0, 1, 0}, 60, 2},
+    {{6, 0, 1, 0}, 62, 10},
+    {{7, 0, 1, 0}, 72, 48},
+    {{7, 0, 1, 0}, 120, 60},
+    {{7, 0, 1, 0}, 180, 60},
+    {{7, 0, 1, 0}, 240, 18},
+    {{7, 0, 1, 0}, 258, 25},
+    {{2, 0, 1, 0}, 283, 9},
+    {{7, 0, 1, 0}, 292, 26},
+    {{7, 0, 1, 0}, 318, 30},
+    {{3, 0, 1, 0}, 348, 6},
+    {{7, 0, 1, 0}, 354, 24},
+    {{3, 0, 1, 0}, 378, 6},
+    {{7, 0, 1, 0}, 384, 54},
+    {{7, 0, 1, 0}, 438, 60},
+    {{7, 0, 1, 0}, 498, 60},
+    {{7, 0, 1, 0}, 558, 51},
+    {{7, 0, 1, 0}, 609, 60},
+    {{7, 0, 1, 0}, 669, 21},
+    {{3, 0, 1, 0}, 690, 9},
+    {{7, 0, 1, 0}, 699, 30},
+    {{7, 0, 1, 0}, 729, 60},
+    {{7, 0, 1, 0}, 789, 42},
+    {{3, 0, 1, 0}, 831, 6},
+    {{7, 0, 1, 0}, 837, 3},
+    {{3, 0, 1, 0}, 840, 1},
+    {{7, 0, 1, 0}, 841, 8},
+    {{7, 0, 1, 0}, 849, 30},
+    {{3, 0, 1, 0}, 879, 8},
+    {{7, 0, 1, 0}, 887, 22},
+    {{7, 0, 1, 0}, 909, 60},
+    {{7, 0, 1, 0}, 969, 27},
+    {{7, 0, 1, 0}, 996, 60},
+    {{7, 0, 1, 0}, 1056, 60},
+    {{7, 0, 1, 0}, 1116, 37},
+    {{5, 0, 1, 0}, 1153, 10},
+    {{7, 0, 1, 0}, 1163, 23},
+    {{2, 0, 1, 0}, 1186, 14},
+    {{7, 0, 1, 0}, 1200, 23},
+    {{7, 0, 1, 0}, 1223, 25},
+    {{1, 0, 1, 0}, 1248, 3},
+    {{7, 0, 1, 0}, 1251, 32},
+    {{7, 0, 1, 0}, 1283, 35},
+    {{1, 0, 1, 0}, 1318, 1},
+    {{7, 0, 1, 0}, 1319, 24},
+    {{7, 0, 1, 0}, 1343, 60},
+    {{7, 0, 1, 0}, 1403, 19},
+    {{7, 0, 1, 0}, 1422, 35},
+    {{1, 0, 1, 0}, 1457, 1},
+    {{7, 0, 1, 0}, 1458, 6},
+    {{1, 0, 1, 0}, 1464, 1},
+    {{7, 0, 1, 0}, 1465, 17},
+    {{7, 0, 1, 0}, 1482, 60},
+    {{7, 0, 1, 0}, 1542, 31},
+    {{1, 0, 1, 0}, 1573, 1},
+    {{7, 0, 1, 0}, 1574, 24},
+    {{1, 0, 1, 0}, 1598, 1},
+    {{7, 0, 1, 0}, 1599, 3},
+    {{7, 0, 1, 0}, 1602, 54},
+    {{1, 0, 1, 0}, 1656, 6},
+    {{7, 0, 1, 0}, 1662, 7},
+    {{1, 0, 1, 0}, 1669, 1},
+    {{7, 0, 1, 0}, 1670, 1},
+    {{7, 0, 1, 0}, 1671, 45},
+    {{1, 0, 1, 0}, 1716, 1},
+    {{7, 0, 1, 0}, 1717, 14},
+    {{7, 0, 1, 0}, 1731, 60},
+    {{7, 0, 1, 0}, 1791, 21},
+    {{7, 0, 1, 0}, 1812, 52},
+    {{1, 0, 1, 0}, 1864, 1},
+    {{7, 0, 1, 0}, 1865, 7},
+    {{7, 0, 1, 0}, 1872, 58},
+    {{7, 0, 1, 0}, 1930, 48},
+    {{7, 0, 1, 0}, 1978, 60},
+    {{7, 0, 1, 0}, 2038, 60},
+    {{7, 0, 1, 0}, 2098, 12},
+    {{1, 0, 1, 0}, 2110, 1},
+    {{7, 0, 1, 0}, 2111, 7},
+    {{1, 0, 1, 0}, 2118, 1},
+    {{7, 0, 1, 0}, 2119, 39},
+    {{7, 0, 1, 0}, 2158, 8},
+    {{7, 0, 1, 0}, 2166, 60},
+    {{7, 0, 1, 0}, 2226, 60},
+    {{7, 0, 1, 0}, 2286, 39},
+};
+
+static const uint16_t help_glyphs[] = {
+    9500, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472,
+    9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 32,
+    72, 111, 119, 32, 116, 111, 32, 80, 108, 97, 121, 32,
+    9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472,
+    9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9508,
+    32, 32, 71, 111, 98, 108, 105, 110, 45, 67, 79, 77,
+    32, 105, 115, 32, 32, 105, 110, 102, 108, 117, 101, 110,
+    99, 101, 100, 32, 104, 101, 97, 118, 105, 108, 121, 32,
+    32, 98, 121, 32, 88, 45, 67, 79, 77, 58, 32, 32,
+    85, 70, 79, 32, 68, 101, 102, 101, 110, 115, 101, 44,
+    98, 117, 116, 32, 114, 97, 116, 104, 101, 114, 32, 116,
+    104, 97, 110, 32, 98, 101, 105, 110, 103, 32, 115, 101,
+    116, 32, 111, 110, 32, 32, 69, 97, 114, 116, 104, 32,
+    105, 110, 32, 116, 104, 101, 32, 100, 105, 115, 116, 97,
+    110, 116, 32, 102, 117, 116, 117, 114, 101, 32, 111, 102,
+    49, 57, 57, 57, 44, 32, 32, 105, 116, 39, 115, 32,
+    115, 101, 116, 32, 32, 105, 110, 32, 32, 97, 32, 84,
+    111, 108, 107, 105, 101, 110, 101, 115, 113, 117, 101, 32,
+    32, 102, 97, 110, 116, 97, 115, 121, 32, 32, 119, 111,
+    114, 108, 100, 32, 97, 116, 32, 32, 115, 111, 109, 101,
+    117, 110, 100, 101, 116, 101, 114, 109, 105, 110, 101, 100,
+    32, 100, 97, 116, 101, 46, 9500, 9472, 9472, 9472, 9472, 9472,
+    9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472,
+    9472, 9472, 9472, 9472, 9472, 9472, 32, 89, 111, 117, 114, 32,
+    82, 111, 108, 101, 32, 9472, 9472, 9472, 9472, 9472, 9472, 9472,
+    9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472,
+    9472, 9472, 9472, 9472, 9472, 9508, 32, 32, 89, 111, 117, 32,
+    32, 99, 111, 110, 116, 114, 111, 108, 32, 32, 97, 32,
+    110, 117, 109, 98, 101, 114, 32, 32, 111, 102, 32, 32,
+    104, 101, 114, 111, 101, 115, 32, 32, 103, 114, 111, 117,
+    112, 101, 100, 32, 116, 111, 103, 101, 116, 104, 101, 114,
+    32, 32, 105, 110, 116, 111, 115, 113, 117, 97, 100, 115,
+    46, 32, 32, 65, 115, 32, 103, 111, 98, 108, 105, 110,
+    115, 32, 32, 97, 114, 114, 105, 118, 101, 44, 32, 116,
+    104, 101, 115, 101, 32, 32, 115, 113, 117, 97, 100, 115,
+    32, 97, 114, 101, 32, 32, 115, 101, 110, 116, 32, 111,
+    117, 116, 32, 32, 116, 111, 105, 110, 116, 101, 114, 99,
+    101, 112, 116, 32, 32, 116, 104, 101, 32, 105, 110, 118,
+    97, 100, 101, 114, 115, 32, 32, 111, 110, 32, 116, 104,
+    101, 32, 32, 103, 101, 111, 115, 99, 97, 112, 101, 32,
+    115, 99, 114, 101, 101, 110, 46, 32, 32, 79, 110, 99,
+    101, 32, 121, 111, 117, 114, 115, 113, 117, 97, 100, 32,
+    99, 97, 116, 99, 104, 101, 115, 32, 117, 112, 32, 119,
+    105, 116, 104, 32, 116, 104, 101, 32, 32, 103, 111, 98,
+    108, 105, 110, 115, 44, 32, 121, 111, 117, 39, 108, 108,
+    32, 98, 101, 32, 100, 114, 111, 112, 112, 101, 100, 32,
+    105, 110, 116, 111, 32, 97, 98, 97, 116, 116, 108, 101,
+    115, 99, 97, 112, 101, 32, 116, 111, 32, 100, 101, 97,
+    108, 32, 119, 105, 116, 104, 32, 116, 104, 101, 109, 32,
+    105, 110, 32, 116, 117, 114, 110, 45, 98, 97, 115, 101,
+    100, 32, 99, 111, 109, 98, 97, 116, 46, 32, 32, 79,
+    110, 32, 116, 104, 101, 32, 103, 101, 111, 115, 99, 97,
+    112, 101, 32, 115, 99, 114, 101, 101, 110, 32, 121, 111,
+    117, 39, 108, 108, 32, 32, 97, 108, 115, 111, 32, 98,
+    101, 32, 97, 98, 108, 101, 32, 116, 111, 32, 99, 111,
+    110, 115, 116, 114, 117, 99, 116, 32, 97, 110, 117, 109,
+    98, 101, 114, 32, 111, 102, 32, 32, 100, 105, 102, 102,
+    101, 114, 101, 110, 116, 32, 98, 117, 105, 108, 100, 105,
+    110, 103, 115, 32, 32, 116, 111, 32, 103, 114, 111, 119,
+    32, 121, 111, 117, 114, 32, 32, 101, 99, 111, 110, 111,
+    109, 105, 99, 32, 98, 97, 115, 101, 46, 66, 117, 105,
+    108, 100, 105, 110, 103, 115, 32, 32, 109, 117, 115, 116,
+    32, 32, 97, 108, 119, 97, 121, 115, 32, 32, 98, 101,
+    32, 99, 111, 110, 115, 116, 114, 117, 99, 116, 101, 100,
+    32, 32, 97, 100, 106, 97, 99, 101, 110, 116, 32, 32,
+    116, 111, 32, 32, 111, 116, 104, 101, 114, 98, 117, 105,
+    108, 100, 105, 110, 103, 115, 46, 32, 89, 111, 117, 32,
+    32, 115, 116, 97, 114, 116, 32, 119, 105, 116, 104, 32,
+    106, 117, 115, 116, 32, 32, 97, 32, 115, 105, 110, 103,
+    108, 101, 32, 99, 97, 115, 116, 108, 101, 32, 32, 40,
+    67, 41, 44, 32, 119, 104, 105, 99, 104, 112, 114, 111,
+    118, 105, 100, 101, 115, 32, 32, 121, 111, 117, 32, 97,
+    32, 32, 98, 97, 115, 101, 32, 115, 101, 116, 32, 32,
+    111, 102, 32, 114, 101, 115, 111, 117, 114, 99, 101, 32,
+    32, 105, 110, 99, 111, 109, 101, 46, 32, 89, 111, 117,
+    32, 32, 109, 117, 115, 116, 32, 98, 101, 99, 97, 114,
+    101, 102, 117, 108, 32, 32, 116, 111, 32, 32, 100, 101,
+    102, 101, 110, 100, 32, 32, 121, 111, 117, 114, 32, 32,
+    32, 98, 117, 105, 108, 100, 105, 110, 103, 115, 44, 32,
+    32, 98, 101, 99, 97, 117, 115, 101, 32, 32, 116, 104,
+    101, 32, 32, 103, 111, 98, 108, 105, 110, 105, 110, 118,
+    97, 100, 101, 114, 115, 32, 119, 105, 108, 108, 32, 100,
+    101, 115, 116, 114, 111, 121, 32, 116, 104, 101, 109, 33,
+    32, 32, 84, 104, 101, 32, 103, 97, 109, 101, 32, 101,
+    110, 100, 115, 32, 119, 104, 101, 110, 32, 101, 105, 116,
+    104, 101, 114, 32, 121, 111, 117, 114, 32, 101, 110, 116,
+    105, 114, 101, 32, 112, 101, 111, 112, 108, 101, 32, 97,
+    114, 101, 32, 119, 105, 112, 101, 100, 32, 111, 117, 116,
+    100, 117, 101, 32, 32, 116, 111, 32, 121, 111, 117, 114,
+    32, 32, 99, 97, 115, 116, 108, 101, 32, 98, 101, 105,
+    110, 103, 32, 32, 104, 101, 97, 118, 105, 108, 121, 32,
+    97, 115, 115, 97, 117, 108, 116, 101, 100, 44, 32, 32,
+    111, 114, 32, 119, 104, 101, 110, 32, 32, 121, 111, 117,
+    102, 105, 103, 117, 114, 101, 32, 111, 117, 116, 32, 104,
+    111, 119, 32, 116, 111, 32, 114, 101, 115, 111, 108, 118,
+    101, 32, 116, 104, 101, 32, 115, 116, 111, 114, 121, 46,
+    32, 71, 111, 111, 100, 32, 108, 117, 99, 107, 33, 9500,
+    9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472,
+    9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 32, 85, 115,
+    101, 114, 32, 73, 110, 116, 101, 114, 102, 97, 99, 101,
+    32, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472,
+    9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9508, 32,
+    32, 65, 110, 121, 116, 104, 105, 110, 103, 32, 32, 109,
+    97, 114, 107, 101, 100, 32, 119, 105, 116, 104, 32, 32,
+    114, 101, 100, 32, 32, 105, 110, 100, 105, 99, 97, 116,
+    101, 115, 32, 97, 32, 32, 107, 101, 121, 32, 98, 105,
+    110, 100, 105, 110, 103, 46, 32, 32, 70, 111, 114, 101,
+    120, 97, 109, 112, 108, 101, 44, 32, 121, 111, 117, 32,
+    32, 115, 104, 111, 117, 108, 100, 32, 104, 97, 118, 101,
+    32, 112, 114, 101, 115, 115, 101, 100, 32, 32, 112, 32,
+    116, 111, 32, 97, 99, 99, 101, 115, 115, 32, 32, 116,
+    104, 105, 115, 32, 119, 105, 110, 100, 111, 119, 44, 97,
+    110, 100, 32, 32, 116, 104, 101, 32, 114, 101, 100, 32,
+    32, 97, 114, 114, 111, 119, 115, 32, 32, 111, 110, 32,
+    32, 116, 104, 101, 32, 114, 105, 103, 104, 116, 32, 32,
+    109, 97, 114, 103, 105, 110, 32, 32, 111, 102, 32, 116,
+    104, 105, 115, 32, 32, 119, 105, 110, 100, 111, 119, 105,
+    110, 100, 105, 99, 97, 116, 101, 32, 115, 99, 114, 111,
+    108, 108, 105, 110, 103, 46, 32, 32, 73, 110, 32, 116,
+    104, 101, 32, 32, 109, 97, 105, 110, 32, 103, 101, 111,
+    115, 99, 97, 112, 101, 32, 118, 105, 101, 119, 44, 32,
+    32, 116, 104, 101, 32, 60, 32, 32, 97, 110, 100, 32,
+    62, 32, 107, 101, 121, 115, 32, 32, 97, 100, 106, 117,
+    115, 116, 32, 116, 104, 101, 115, 112, 101, 101, 100, 46,
+    32, 32, 68, 105, 102, 102, 101, 114, 101, 110, 116, 32,
+    115, 117, 98, 109, 101, 110, 117, 115, 32, 32, 97, 114,
+    101, 32, 97, 99, 99, 101, 115, 115, 101, 100, 32, 32,
+    98, 121, 32, 112, 114, 101, 115, 115, 105, 110, 103, 32,
+    32, 116, 104, 101, 105, 114, 100, 105, 115, 112, 108, 97,
+    121, 101, 100, 32, 114, 101, 100, 32, 107, 101, 121, 32,
+    98, 105, 110, 100, 105, 110, 103, 46, 32, 85, 115, 101,
+    32, 113, 32, 32, 116, 111, 32, 115, 97, 118, 101, 32,
+    97, 110, 100, 32, 113, 117, 105, 116, 44, 32, 97, 110,
+    100, 32, 81, 32, 116, 111, 113, 117, 105, 116, 32, 119,
+    105, 116, 104, 111, 117, 116, 32, 115, 97, 118, 105, 110,
+    103, 46, 32, 65, 110, 121, 32, 109, 101, 110, 117, 32,
+    99, 97, 110, 32, 98, 101, 32, 101, 120, 105, 116, 101,
+    100, 32, 117, 115, 105, 110, 103, 32, 116, 104, 101, 32,
+    101, 115, 99, 97, 112, 101, 107, 101, 121, 32, 111, 114,
+    32, 113, 46, 32, 32, 84, 104, 101, 32, 32, 119, 111,
+    114, 108, 100, 32, 105, 115, 32, 99, 104, 101, 99, 107,
+    112, 111, 105, 110, 116, 101, 100, 32, 101, 118, 101, 114,
+    121, 32, 104, 111, 117, 114, 44, 32, 97, 110, 100, 32,
+    114, 32, 114, 101, 119, 105, 110, 100, 115, 32, 105, 116,
+    32, 98, 121, 97, 110, 32, 104, 111, 117, 114, 46, 32,
+    85, 112, 32, 116, 111, 32, 116, 101, 110, 32, 100, 97,
+    121, 115, 32, 97, 114, 101, 32, 107, 101, 112, 116, 44,
+    32, 115, 111, 32, 112, 114, 101, 115, 115, 105, 110, 103,
+    32, 105, 116, 32, 97, 103, 97, 105, 110, 32, 115, 116,
+    101, 112, 115, 102, 117, 114, 116, 104, 101, 114, 32, 98,
+    97, 99, 107, 32, 105, 110, 32, 116, 105, 109, 101, 46,
+    32, 32, 87, 111, 114, 108, 100, 115, 32, 99, 97, 110,
+    32, 98, 101, 32, 108, 97, 114, 103, 101, 114, 32, 116,
+    104, 97, 110, 32, 116, 104, 101, 32, 115, 99, 114, 101,
+    101, 110, 44, 32, 112, 105, 99, 107, 101, 100, 32, 119,
+    105, 116, 104, 32, 122, 32, 111, 110, 32, 116, 104, 101,
+    116, 105, 116, 108, 101, 32, 115, 99, 114, 101, 101, 110,
+    46, 32, 84, 104, 101, 32, 97, 114, 114, 111, 119, 32,
+    107, 101, 121, 115, 32, 116, 104, 101, 110, 32, 115, 99,
+    114, 111, 108, 108, 32, 116, 104, 101, 32, 103, 101, 111,
+    115, 99, 97, 112, 101, 44, 32, 97, 110, 100, 105, 116,
+    32, 102, 111, 108, 108, 111, 119, 115, 32, 116, 104, 101,
+    32, 99, 117, 114, 115, 111, 114, 32, 119, 104, 101, 110,
+    32, 121, 111, 117, 32, 112, 108, 97, 99, 101, 32, 97,
+    32, 98, 117, 105, 108, 100, 105, 110, 103, 46, 32, 32,
+    79, 110, 32, 116, 104, 101, 32, 32, 104, 101, 114, 111,
+    101, 115, 32, 119, 105, 110, 100, 111, 119, 32, 117, 115,
+    101, 32, 32, 116, 104, 101, 32, 97, 114, 114, 111, 119,
+    32, 32, 107, 101, 121, 115, 32, 116, 111, 32, 109, 111,
+    118, 101, 32, 32, 117, 112, 32, 97, 110, 100, 100, 111,
+    119, 110, 32, 116, 104, 114, 111, 117, 103, 104, 32, 32,
+    121, 111, 117, 114, 32, 97, 118, 97, 105, 108, 97, 98,
+    108, 101, 32, 104, 101, 114, 111, 101, 115, 46, 32, 32,
+    85, 115, 101, 32, 60, 32, 97, 110, 100, 32, 62, 32,
+    32, 116, 111, 32, 115, 119, 105, 116, 99, 104, 112, 97,
+    103, 101, 115, 46, 32, 32, 85, 115, 101, 32, 43, 32,
+    32, 97, 110, 100, 32, 32, 45, 32, 116, 111, 32, 32,
+    97, 100, 106, 117, 115, 116, 32, 116, 111, 32, 32, 119,
+    104, 105, 99, 104, 32, 32, 115, 113, 117, 97, 100, 32,
+    116, 104, 105, 115, 32, 32, 104, 101, 114, 111, 98, 101,
+    108, 111, 110, 103, 115, 46, 32, 32, 79, 110, 32, 116,
+    104, 101, 32, 115, 113, 117, 97, 100, 115, 32, 119, 105,
+    110, 100, 111, 119, 32, 112, 114, 101, 115, 115, 32, 32,
+    116, 104, 101, 32, 115, 113, 117, 97, 100, 39, 115, 32,
+    108, 101, 116, 116, 101, 114, 32, 116, 111, 32, 115, 101,
+    108, 101, 99, 116, 32, 97, 110, 101, 119, 32, 32, 116,
+    97, 114, 103, 101, 116, 32, 102, 111, 114, 32, 32, 116,
+    104, 97, 116, 32, 115, 113, 117, 97, 100, 46, 32, 32,
+    73, 110, 118, 97, 100, 101, 114, 115, 32, 119, 105, 108,
+    108, 32, 32, 98, 101, 32, 109, 97, 114, 107, 101, 100,
+    32, 32, 119, 105, 116, 104, 117, 110, 105, 113, 117, 101,
+    32, 108, 101, 116, 116, 101, 114, 115, 32, 102, 114, 111,
+    109, 32, 119, 104, 105, 99, 104, 32, 121, 111, 117, 32,
+    99, 97, 110, 32, 112, 105, 99, 107, 46,
+};
+
+const text_t text_help = {
+    56, help_line, help_runs, help_glyphs
+};
+
+static const uint16_t game_over_line[] = {
+    0, 3, 3, 4, 5, 6, 7, 8, 9, 9, 10, 11,
+    12, 13, 14, 15, 16,
+};
+
+static const struct text_run game_over_runs[] = {
+    {{7, 0, 1, 0}, 0, 24},
+    {{1, 0, 1, 0}, 24, 9},
+    {{7, 0, 1, 0}, 33, 12},
+    {{7, 0, 1, 0}, 45, 60},
+    {{7, 0, 1, 0}, 105, 60},
+    {{7, 0, 1, 0}, 165, 60},
+    {{7, 0, 1, 0}, 225, 60},
+    {{7, 0, 1, 0}, 285, 60},
+    {{7, 0, 1, 0}, 345, 29},
+    {{7, 0, 1, 0}, 374, 60},
+    {{7, 0, 1, 0}, 434, 60},
+    {{7, 0, 1, 0}, 494, 60},
+    {{7, 0, 1, 0}, 554, 60},
+    {{7, 0, 1, 0}, 614, 60},
+    {{7, 0, 1, 0}, 674, 60},
+    {{7, 0, 1, 0}, 734, 7},
+};
+
+static const uint16_t game_over_glyphs[] = {
+    32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32,
+    9500, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 32,
+    71, 97, 109, 101, 32, 79, 118, 101, 114, 32, 9472, 9472,
+    9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9508, 32, 32, 68,
+    101, 115, 112, 105, 116, 101, 32, 116, 104, 101, 32, 98,
+    101, 115, 116, 32, 101, 102, 102, 111, 114, 116, 32, 111,
+    102, 32, 32, 121, 111, 117, 114, 32, 104, 101, 114, 111,
+    101, 115, 44, 32, 108, 97, 121, 105, 110, 103, 32, 100,
+    111, 119, 110, 32, 116, 104, 101, 105, 114, 108, 105, 118,
+    101, 115, 32, 102, 111, 114, 32, 32, 116, 104, 101, 32,
+    115, 97, 107, 101, 32, 111, 102, 32, 32, 97, 108, 108,
+    44, 32, 115, 117, 112, 112, 111, 114, 116, 101, 100, 32,
+    116, 104, 101, 32, 105, 110, 100, 117, 115, 116, 114, 121,
+    32, 32, 111, 102, 32, 121, 111, 117, 114, 112, 101, 111,
+    112, 108, 101, 44, 32, 121, 111, 117, 32, 104, 97, 118,
+    101, 32, 32, 102, 97, 105, 108, 101, 100, 32, 116, 111,
+    32, 115, 116, 111, 112, 32, 116, 104, 101, 32, 32, 103,
+    111, 98, 108, 105, 110, 32, 111, 110, 115, 108, 97, 117,
+    103, 104, 116, 46, 32, 87, 105, 116, 104, 121, 111, 117,
+    114, 32, 110, 97, 116, 105, 111, 110, 32, 105, 110, 32,
+    32, 116, 97, 116, 116, 101, 114, 115, 32, 97, 114, 111,
+    117, 110, 100, 32, 105, 116, 44, 32, 116, 104, 101, 32,
+    32, 103, 111, 98, 108, 105, 110, 115, 32, 115, 116, 111,
+    114, 109, 101, 100, 32, 121, 111, 117, 114, 99, 97, 115,
+    116, 108, 101, 44, 32, 107, 105, 108, 108, 101, 100, 32,
+    101, 118, 101, 114, 121, 111, 110, 101, 32, 116, 104, 101,
+    121, 32, 99, 111, 117, 108, 100, 32, 102, 105, 110, 100,
+    44, 32, 97, 110, 100, 32, 108, 101, 102, 116, 32, 118,
+    105, 99, 116, 111, 114, 105, 111, 117, 115, 119, 105, 116,
+    104, 32, 116, 104, 101, 32, 109, 121, 115, 116, 101, 114,
+    105, 111, 117, 115, 32, 97, 114, 116, 105, 102, 97, 99,
+    116, 46, 32, 32, 79, 110, 108, 121, 32, 97, 32, 32,
+    102, 101, 119, 32, 115, 117, 114, 118, 105, 118, 111, 114,
+    115, 32, 108, 105, 118, 101, 32, 116, 111, 32, 32, 116,
+    101, 108, 108, 32, 116, 104, 101, 32, 116, 97, 108, 101,
+    46, 32, 65, 108, 108, 32, 32, 116, 104, 97, 116, 32,
+    105, 115, 107, 110, 111, 119, 110, 32, 111, 102, 32, 32,
+    116, 104, 101, 32, 97, 114, 116, 105, 102, 97, 99, 116,
+    32, 98, 121, 32, 104, 117, 109, 97, 110, 32, 32, 99,
+    105, 118, 105, 108, 105, 122, 97, 116, 105, 111, 110, 44,
+    32, 105, 110, 99, 108, 117, 100, 105, 110, 103, 32, 105,
+    116, 115, 118, 101, 114, 121, 32, 32, 101, 120, 105, 115,
+    116, 101, 110, 99, 101, 44, 32, 105, 115, 32, 32, 108,
+    111, 115, 116, 32, 105, 110, 32, 32, 100, 101, 102, 101,
+    97, 116, 46, 32, 87, 104, 97, 116, 32, 32, 112, 117,
+    114, 112, 111, 115, 101, 32, 119, 105, 108, 108, 32, 32,
+    105, 116, 115, 101, 114, 118, 101, 32, 105, 110, 32, 32,
+    116, 104, 101, 32, 102, 117, 116, 117, 114, 101, 63, 32,
+    87, 105, 108, 108, 32, 32, 116, 104, 105, 115, 32, 109,
+    97, 107, 101, 32, 116, 104, 101, 32, 32, 103, 111, 98,
+    108, 105, 110, 115, 32, 115, 116, 114, 111, 110, 103, 101,
+    114, 44, 102, 117, 114, 116, 104, 101, 114, 32, 32, 116,
+    104, 114, 101, 97, 116, 101, 110, 105, 110, 103, 32, 116,
+    104, 101, 32, 32, 114, 101, 103, 105, 111, 110, 63, 32,
+    80, 101, 114, 104, 97, 112, 115, 32, 32, 116, 104, 101,
+    32, 111, 116, 104, 101, 114, 32, 32, 105, 115, 108, 97,
+    110, 100, 110, 97, 116, 105, 111, 110, 115, 32, 119, 105,
+    108, 108, 32, 32, 102, 97, 114, 101, 32, 98, 101, 116,
+    116, 101, 114, 32, 119, 104, 101, 110, 32, 32, 116, 104,
+    101, 32, 103, 111, 98, 108, 105, 110, 115, 32, 97, 114,
+    114, 105, 118, 101, 32, 32, 97, 116, 32, 116, 104, 101,
+    105, 114, 115, 104, 111, 114, 101, 115, 46,
+};
+
+const text_t text_game_over = {
+    16, game_over_line, game_over_runs, game_over_glyphs
+};
+
+static const uint16_t halfway_line[] = {
+    0, 1, 2, 5, 6, 6, 7, 8, 9, 10, 11, 11,
+    12, 13, 14, 14, 15, 18, 19, 19, 20, 21, 22, 22,
+    25, 27, 28, 29, 30, 31, 31, 32, 32, 33, 38, 39,
+    41, 42, 43, 43, 44, 44, 47, 50, 53, 54, 57, 60,
+    60, 61, 62, 63, 64,
+};
+
+static const struct text_run halfway_runs[] = {
+    {{7, 0, 1, 0}, 0, 60},
+    {{7, 0, 1, 0}, 60, 60},
+    {{7, 0, 1, 0}, 120, 33},
+    {{5, 0, 1, 0}, 153, 11},
+    {{7, 0, 1, 0}, 164, 16},
+    {{7, 0, 1, 0}, 180, 49},
+    {{7, 0, 1, 0}, 229, 60},
+    {{7, 0, 1, 0}, 289, 60},
+    {{7, 0, 1, 0}, 349, 60},
+    {{7, 0, 1, 0}, 409, 60},
+    {{7, 0, 1, 0}, 469, 28},
+    {{7, 0, 1, 0}, 497, 60},
+    {{7, 0, 1, 0}, 557, 60},
+    {{7, 0, 1, 0}, 617, 7},
+    {{7, 0, 1, 0}, 624, 60},
+    {{7, 0, 1, 0}, 684, 18},
+    {{3, 0, 1, 0}, 702, 8},
+    {{7, 0, 1, 0}, 710, 34},
+    {{7, 0, 1, 0}, 744, 44},
+    {{7, 0, 1, 0}, 788, 60},
+    {{7, 0, 1, 0}, 848, 60},
+    {{7, 0, 1, 0}, 908, 7},
+    {{7, 0, 1, 0}, 915, 8},
+    {{3, 0, 1, 0}, 923, 8},
+    {{7, 0, 1, 0}, 931, 44},
+    {{7, 0, 1, 0}, 975, 53},
+    {{1, 0, 1, 0}, 1028, 7},
+    {{7, 0, 1, 0}, 1035, 60},
+    {{7, 0, 1, 0}, 1095, 60},
+    {{7, 0, 1, 0}, 1155, 60},
+    {{7, 0, 1, 0}, 1215, 28},
+    {{7, 0, 1, 0}, 1243, 49},
+    {{7, 0, 1, 0}, 1292, 60},
+    {{7, 0, 1, 0}, 1352, 5},
+    {{3, 0, 1, 0}, 1357, 8},
+    {{7, 0, 1, 0}, 1365, 33},
+    {{3, 0, 1, 0}, 1398, 8},
+    {{7, 0, 1, 0}, 1406, 6},
+    {{7, 0, 1, 0}, 1412, 60},
+    {{7, 0, 1, 0}, 1472, 52},
+    {{3, 0, 1, 0}, 1524, 8},
+    {{7, 0, 1, 0}, 1532, 60},
+    {{7, 0, 1, 0}, 1592, 37},
+    {{7, 0, 1, 0}, 1629, 33},
+    {{7, 0, 1, 0}, 1662, 22},
+    {{5, 0, 1, 0}, 1684, 24},
+    {{7, 0, 1, 0}, 1708, 14},
+    {{7, 0, 1, 0}, 1722, 13},
+    {{6, 0, 1, 0}, 1735, 7},
+    {{7, 0, 1, 0}, 1742, 40},
+    {{7, 0, 1, 0}, 1782, 26},
+    {{3, 0, 1, 0}, 1808, 8},
+    {{7, 0, 1, 0}, 1816, 26},
+    {{7, 0, 1, 0}, 1842, 60},
+    {{7, 0, 1, 0}, 1902, 30},
+    {{1, 0, 1, 0}, 1932, 7},
+    {{7, 0, 1, 0}, 1939, 23},
+    {{7, 0, 1, 0}, 1962, 32},
+    {{3, 0, 1, 0}, 1994, 8},
+    {{7, 0, 1, 0}, 2002, 13},
+    {{7, 0, 1, 0}, 2015, 60},
+    {{7, 0, 1, 0}, 2075, 60},
+    {{7, 0, 1, 0}, 2135, 60},
+    {{7, 0, 1, 0}, 2195, 47},
+};
+
+static const uint16_t halfway_glyphs[] = {
+    32, 32, 73, 110, 32, 116, 104, 101, 32, 100, 97, 114,
+    107, 101, 115, 116, 32, 112, 97, 114, 116, 32, 111, 102,
+    32, 116, 104, 101, 32, 110, 105, 103, 104, 116, 32, 121,
+    111, 117, 32, 97, 114, 101, 32, 97, 119, 111, 107, 101,
+    110, 32, 116, 111, 32, 98, 97, 110, 103, 105, 110, 103,
+    111, 110, 32, 32, 121, 111, 117, 114, 32, 99, 104, 97,
+    109, 98, 101, 114, 32, 32, 100, 111, 111, 114, 115, 46,
+    32, 32, 89, 111, 117, 32, 32, 119, 101, 97, 114, 105,
+    108, 121, 32, 115, 108, 105, 112, 32, 32, 111, 117, 116,
+    32, 32, 111, 102, 32, 98, 101, 100, 32, 32, 116, 111,
+    97, 110, 115, 119, 101, 114, 44, 32, 115, 108, 105, 112,
+    112, 105, 110, 103, 32, 111, 110, 32, 121, 111, 117, 114,
+    32, 107, 105, 110, 103, 108, 121, 32, 32, 112, 117, 114,
+    112, 108, 101, 32, 114, 111, 98, 101, 46, 32, 87, 104,
+    111, 32, 119, 111, 117, 108, 100, 32, 100, 97, 114, 101,
+    100, 105, 115, 116, 117, 114, 98, 32, 116, 104, 101, 32,
+    114, 111, 121, 97, 108, 32, 115, 108, 101, 101, 112, 44,
+    32, 101, 115, 112, 101, 99, 105, 97, 108, 108, 121, 32,
+    97, 116, 32, 116, 104, 105, 115, 32, 104, 111, 117, 114,
+    63, 32, 32, 66, 101, 104, 105, 110, 100, 32, 116, 104,
+    101, 32, 100, 111, 111, 114, 32, 121, 111, 117, 32, 102,
+    105, 110, 100, 32, 32, 116, 104, 101, 32, 99, 97, 115,
+    116, 108, 101, 39, 115, 32, 104, 101, 97, 100, 32, 119,
+    105, 122, 97, 114, 100, 44, 32, 119, 105, 110, 100, 101,
+    100, 97, 110, 100, 32, 32, 115, 119, 101, 97, 116, 105,
+    110, 103, 32, 102, 114, 111, 109, 32, 32, 114, 97, 99,
+    105, 110, 103, 32, 32, 117, 112, 32, 116, 104, 101, 32,
+    32, 119, 105, 110, 100, 105, 110, 103, 32, 32, 115, 116,
+    97, 105, 114, 115, 32, 116, 111, 32, 32, 121, 111, 117,
+    114, 98, 101, 100, 114, 111, 111, 109, 46, 32, 84, 104,
+    101, 32, 32, 108, 111, 110, 103, 32, 98, 101, 97, 114,
+    100, 32, 32, 99, 101, 114, 116, 97, 105, 110, 108, 121,
+    32, 100, 105, 100, 110, 39, 116, 32, 104, 101, 108, 112,
+    32, 32, 109, 97, 116, 116, 101, 114, 115, 46, 32, 72,
+    101, 108, 111, 111, 107, 101, 100, 32, 97, 110, 120, 105,
+    111, 117, 115, 32, 32, 116, 111, 32, 100, 101, 108, 105,
+    118, 101, 114, 32, 32, 105, 109, 112, 111, 114, 116, 97,
+    110, 116, 32, 110, 101, 119, 115, 44, 32, 98, 117, 116,
+    32, 32, 119, 97, 115, 32, 119, 97, 105, 116, 105, 110,
+    103, 112, 97, 116, 105, 101, 110, 116, 108, 121, 32, 102,
+    111, 114, 32, 121, 111, 117, 114, 32, 114, 101, 115, 112,
+    111, 110, 115, 101, 46, 32, 32, 34, 73, 32, 104, 111,
+    112, 101, 32, 116, 104, 105, 115, 32, 105, 115, 32, 105,
+    109, 112, 111, 114, 116, 97, 110, 116, 44, 34, 32, 32,
+    121, 111, 117, 32, 115, 97, 121, 32, 119, 105, 116, 104,
+    32, 97, 32, 121, 97, 119, 110, 44, 32, 114, 101, 102,
+    117, 115, 105, 110, 103, 116, 111, 32, 98, 117, 100, 103,
+    101, 32, 102, 114, 111, 109, 32, 32, 116, 104, 101, 32,
+    100, 111, 111, 114, 119, 97, 121, 44, 32, 108, 101, 115,
+    116, 32, 116, 104, 101, 32, 119, 105, 122, 97, 114, 100,
+    32, 116, 114, 121, 32, 32, 116, 111, 32, 112, 117, 115,
+    104, 32, 104, 105, 115, 119, 97, 121, 32, 105, 110, 46,
+    32, 32, 34, 77, 121, 32, 32, 105, 110, 116, 101, 114,
+    114, 117, 112, 116, 105, 111, 110, 32, 32, 105, 115, 32,
+    32, 111, 102, 32, 32, 32, 116, 104, 101, 32, 32, 117,
+    116, 109, 111, 115, 116, 32, 32, 105, 109, 112, 111, 114,
+    116, 97, 110, 99, 101, 44, 32, 32, 121, 111, 117, 114,
+    109, 97, 106, 101, 115, 116, 121, 46, 32, 73, 116, 39,
+    115, 32, 116, 104, 101, 32, 102, 105, 103, 117, 114, 105,
+    110, 101, 33, 32, 73, 32, 116, 104, 105, 110, 107, 32,
+    73, 39, 118, 101, 32, 100, 105, 115, 99, 111, 118, 101,
+    114, 101, 100, 32, 105, 116, 115, 32, 116, 114, 117, 101,
+    110, 97, 116, 117, 114, 101, 46, 32, 87, 101, 32, 99,
+    97, 110, 32, 112, 117, 116, 32, 97, 110, 32, 101, 110,
+    100, 32, 116, 111, 32, 116, 104, 105, 115, 32, 105, 110,
+    118, 97, 115, 105, 111, 110, 46, 34, 32, 32, 34, 71,
+    111, 32, 111, 110, 46, 34, 32, 89, 111, 117, 32, 32,
+    98, 101, 99, 107, 111, 110, 32, 116, 104, 101, 32, 119,
+    105, 122, 97, 114, 100, 32, 105, 110, 116, 111, 32, 116,
+    104, 101, 32, 114, 111, 111, 109, 46, 32, 32, 89, 111,
+    117, 32, 116, 97, 107, 101, 32, 97, 115, 101, 97, 116,
+    32, 32, 111, 110, 32, 116, 104, 101, 32, 32, 115, 105,
+    100, 101, 32, 111, 102, 32, 32, 121, 111, 117, 114, 32,
+    98, 101, 100, 32, 32, 110, 101, 120, 116, 32, 116, 111,
+    32, 32, 116, 104, 101, 32, 99, 114, 117, 109, 98, 108,
+    101, 100, 32, 32, 115, 105, 108, 107, 115, 104, 101, 101,
+    116, 115, 46, 32, 32, 34, 84, 104, 101, 32, 32, 102,
+    105, 103, 117, 114, 105, 110, 101, 32, 119, 97, 115, 32,
+    32, 99, 114, 101, 97, 116, 101, 100, 32, 32, 109, 105,
+    108, 108, 101, 110, 110, 105, 97, 32, 97, 103, 111, 32,
+    32, 98, 121, 32, 97, 110, 32, 32, 97, 110, 99, 105,
+    101, 110, 116, 104, 117, 109, 97, 110, 32, 99, 105, 118,
+    105, 108, 105, 122, 97, 116, 105, 111, 110, 46, 32, 73,
+    116, 39, 115, 32, 112, 117, 114, 112, 111, 115, 101, 32,
+    32, 119, 97, 115, 32, 110, 111, 116, 32, 116, 111, 32,
+    97, 116, 116, 114, 97, 99, 116, 32, 103, 111, 98, 108,
+    105, 110, 115, 116, 111, 119, 97, 114, 100, 115, 32, 115,
+    111, 109, 101, 116, 104, 105, 110, 103, 46, 32, 32, 73,
+    116, 32, 119, 97, 115, 32, 109, 101, 97, 110, 116, 32,
+    32, 116, 111, 32, 97, 116, 116, 114, 97, 99, 116, 32,
+    116, 104, 101, 109, 32, 32, 97, 119, 97, 121, 32, 102,
+    114, 111, 109, 116, 104, 101, 32, 32, 99, 105, 118, 105,
+    108, 105, 122, 101, 100, 32, 32, 114, 101, 103, 105, 111,
+    110, 115, 32, 32, 111, 102, 32, 32, 116, 104, 101, 32,
+    32, 119, 111, 114, 108, 100, 46, 32, 32, 85, 110, 102,
+    111, 114, 116, 117, 110, 97, 116, 101, 108, 121, 32, 32,
+    111, 117, 114, 115, 101, 116, 116, 108, 101, 109, 101, 110,
+    116, 32, 106, 117, 115, 116, 32, 104, 97, 112, 112, 101,
+    110, 101, 100, 32, 32, 116, 111, 32, 112, 105, 99, 107,
+    32, 111, 110, 101, 32, 111, 102, 32, 32, 116, 104, 101,
+    32, 115, 112, 111, 116, 115, 32, 115, 101, 108, 101, 99,
+    116, 101, 100, 102, 111, 114, 32, 111, 110, 101, 32, 111,
+    102, 32, 116, 104, 101, 115, 101, 32, 97, 114, 116, 105,
+    102, 97, 99, 116, 115, 46, 34, 32, 32, 89, 111, 117,
+    32, 105, 110, 116, 101, 114, 114, 117, 112, 116, 44, 32,
+    34, 72, 111, 119, 32, 100, 111, 101, 115, 32, 116, 104,
+    105, 115, 32, 107, 110, 111, 119, 108, 101, 100, 103, 101,
+    32, 117, 112, 32, 117, 115, 63, 34, 32, 32, 34, 89,
+    111, 117, 32, 100, 105, 100, 110, 39, 116, 32, 108, 101,
+    116, 32, 32, 109, 101, 32, 102, 105, 110, 105, 115, 104,
+    44, 32, 121, 111, 117, 114, 32, 109, 97, 106, 101, 115,
+    116, 121, 46, 32, 32, 84, 104, 101, 32, 99, 114, 101,
+    97, 116, 111, 114, 115, 32, 111, 102, 116, 104, 101, 32,
+    32, 97, 114, 116, 105, 102, 97, 99, 116, 32, 97, 110,
+    116, 105, 99, 105, 112, 97, 116, 101, 100, 32, 32, 111,
+    117, 114, 32, 32, 100, 105, 108, 101, 109, 109, 97, 46,
+    32, 32, 84, 104, 101, 32, 97, 114, 116, 105, 102, 97,
+    99, 116, 32, 32, 119, 105, 108, 108, 97, 117, 116, 111,
+    109, 97, 116, 105, 99, 97, 108, 108, 121, 32, 32, 115,
+    104, 117, 116, 32, 100, 111, 119, 110, 32, 32, 97, 102,
+    116, 101, 114, 32, 97, 32, 32, 99, 101, 114, 116, 97,
+    105, 110, 32, 110, 117, 109, 98, 101, 114, 32, 32, 111,
+    102, 32, 117, 110, 105, 113, 117, 101, 104, 117, 109, 97,
+    110, 32, 105, 110, 100, 105, 118, 105, 100, 117, 97, 108,
+    115, 32, 104, 97, 118, 101, 32, 116, 111, 117, 99, 104,
+    101, 100, 32, 105, 116, 46, 32, 32, 84, 104, 97, 116,
+    32, 119, 97, 121, 32, 105, 102, 32, 116, 104, 101, 32,
+    97, 114, 116, 105, 102, 97, 99, 116, 119, 101, 114, 101,
+    32, 116, 111, 32, 102, 105, 110, 100, 32, 105, 116, 115,
+    32, 119, 97, 121, 32, 116, 111, 32, 32, 97, 32, 104,
+    117, 109, 97, 110, 32, 99, 105, 118, 105, 108, 105, 122,
+    97, 116, 105, 111, 110, 44, 32, 105, 116, 32, 119, 111,
+    117, 108, 100, 32, 115, 104, 117, 116, 100, 111, 119, 110,
+    32, 98, 101, 102, 111, 114, 101, 32, 99, 97, 117, 115,
+    105, 110, 103, 32, 105, 116, 115, 32, 100, 101, 115, 116,
+    114, 117, 99, 116, 105, 111, 110, 46, 34, 32, 32, 34,
+    72, 111, 119, 32, 109, 97, 110, 121, 32, 112, 101, 111,
+    112, 108, 101, 32, 119, 105, 108, 108, 32, 105, 116, 32,
+    116, 97, 107, 101, 63, 34, 32, 32, 34, 66, 121, 32,
+    32, 109, 121, 32, 101, 115, 116, 105, 109, 97, 116, 101,
+    115, 44, 32, 32, 119, 101, 39, 108, 108, 32, 110, 101,
+    101, 100, 32, 32, 52, 44, 48, 48, 48, 32, 112, 101,
+    111, 112, 108, 101, 46, 32, 32, 73, 102, 32, 121, 111,
+    117, 32, 32, 99, 97, 110, 98, 117, 105, 108, 100, 32,
+    101, 110, 111, 117, 103, 104, 32, 104, 97, 109, 108, 101,
+    116, 115, 32, 32, 116, 111, 32, 97, 116, 116, 114, 97,
+    99, 116, 32, 52, 44, 48, 48, 48, 32, 112, 101, 111,
+    112, 108, 101, 32, 32, 116, 111, 32, 108, 105, 118, 101,
+    32, 117, 110, 100, 101, 114, 121, 111, 117, 114, 32, 114,
+    117, 108, 101, 44, 32, 73, 39, 108, 108, 32, 104, 97,
+    118, 101, 32, 116, 104, 101, 32, 32, 102, 105, 103, 117,
+    114, 105, 110, 101, 32, 115, 101, 110, 116, 32, 97, 114,
+    111, 117, 110, 100, 32, 116, 104, 101, 32, 114, 101, 97,
+    108, 109, 32, 102, 111, 114, 101, 97, 99, 104, 32, 109,
+    97, 110, 44, 32, 32, 119, 111, 109, 97, 110, 44, 32,
+    97, 110, 100, 32, 32, 99, 104, 105, 108, 100, 32, 116,
+    111, 32, 32, 116, 111, 117, 99, 104, 46, 32, 73, 102,
+    32, 32, 73, 32, 97, 110, 100, 32, 32, 116, 104, 101,
+    32, 111, 116, 104, 101, 114, 119, 105, 122, 97, 114, 100,
+    115, 32, 32, 97, 114, 101, 32, 32, 99, 111, 114, 114,
+    101, 99, 116, 44, 32, 32, 116, 104, 101, 32, 32, 32,
+    103, 111, 98, 108, 105, 110, 115, 32, 32, 119, 105, 108,
+    108, 32, 32, 105, 110, 115, 116, 97, 110, 116, 108, 121,
+    32, 32, 108, 111, 115, 101, 105, 110, 116, 101, 114, 101,
+    115, 116, 32, 105, 110, 32, 111, 117, 114, 32, 105, 115,
+    108, 97, 110, 100, 32, 119, 104, 101, 110, 32, 116, 104,
+    101, 32, 97, 114, 116, 105, 102, 97, 99, 116, 32, 115,
+    104, 117, 116, 115, 32, 100, 111, 119, 110, 46, 34, 32,
+    32, 34, 84, 104, 97, 116, 32, 32, 115, 111, 117, 110,
+    100, 115, 32, 108, 105, 107, 101, 32, 32, 115, 111, 109,
+    101, 32, 115, 116, 117, 112, 105, 100, 32, 32, 103, 105,
+    109, 109, 105, 99, 107, 32, 116, 104, 97, 116, 32, 32,
+    97, 32, 98, 97, 100, 32, 32, 103, 97, 109, 101, 100,
+    101, 115, 105, 103, 110, 101, 114, 32, 99, 97, 109, 101,
+    32, 117, 112, 32, 119, 105, 116, 104, 32, 105, 110, 32,
+    97, 32, 32, 114, 117, 115, 104, 32, 98, 101, 102, 111,
+    114, 101, 32, 97, 32, 100, 101, 97, 100, 108, 105, 110,
+    101, 46, 32, 66, 117, 116, 32, 73, 39, 108, 108, 100,
+    111, 32, 105, 116, 46, 32, 66, 117, 105, 108, 100, 105,
+    110, 103, 32, 116, 104, 97, 116, 32, 115, 111, 114, 116,
+    32, 111, 102, 32, 105, 110, 102, 114, 97, 115, 116, 114,
+    117, 99, 117, 114, 101, 32, 99, 111, 117, 108, 100, 32,
+    116, 97, 107, 101, 44, 32, 108, 105, 107, 101, 44, 115,
+    101, 118, 101, 110, 32, 100, 97, 121, 115, 46, 32, 66,
+    117, 116, 32, 102, 105, 114, 115, 116, 44, 32, 73, 32,
+    104, 97, 118, 101, 32, 115, 108, 101, 101, 112, 32, 116,
+    111, 32, 102, 105, 110, 105, 115, 104, 46, 34,
+};
+
+const text_t text_halfway = {
+    52, halfway_line, halfway_runs, halfway_glyphs
+};
+
+static const uint16_t win_line[] = {
+    0, 1, 2, 3, 5, 6, 7, 8, 8, 9, 10, 12,
+    13, 14, 14, 15, 16, 19, 20, 20, 21, 21, 22, 23,
+    23, 26, 27, 27, 28, 29, 30, 30, 31, 32, 32, 35,
+    36, 36, 37, 38, 39, 39, 40, 41, 41, 42, 43, 46,
+    49, 49, 52, 54, 55, 58, 59, 59, 60, 60, 65, 66,
+    69, 69, 70, 70, 71, 72, 74, 74, 76,
+};
+
+static const struct text_run win_runs[] = {
+    {{7, 0, 1, 0}, 0, 60},
+    {{7, 0, 1, 0}, 60, 60},
+    {{7, 0, 1, 0}, 120, 60},
+    {{3, 0, 1, 0}, 180, 8},
+    {{7, 0, 1, 0}, 188, 52},
+    {{7, 0, 1, 0}, 240, 60},
+    {{7, 0, 1, 0}, 300, 60},
+    {{7, 0, 1, 0}, 360, 54},
+    {{7, 0, 1, 0}, 414, 60},
+    {{7, 0, 1, 0}, 474, 60},
+    {{7, 0, 1, 0}, 534, 52},
+    {{3, 0, 1, 0}, 586, 8},
+    {{7, 0, 1, 0}, 594, 60},
+    {{7, 0, 1, 0}, 654, 18},
+    {{7, 0, 1, 0}, 672, 60},
+    {{7, 0, 1, 0}, 732, 60},
+    {{7, 0, 1, 0}, 792, 31},
+    {{3, 0, 1, 0}, 823, 8},
+    {{7, 0, 1, 0}, 831, 21},
+    {{7, 0, 1, 0}, 852, 22},
+    {{7, 0, 1, 0}, 874, 50},
+    {{7, 0, 1, 0}, 924, 60},
+    {{7, 0, 1, 0}, 984, 54},
+    {{7, 0, 1, 0}, 1038, 30},
+    {{3, 0, 1, 0}, 1068, 8},
+    {{7, 0, 1, 0}, 1076, 22},
+    {{7, 0, 1, 0}, 1098, 15},
+    {{7, 0, 1, 0}, 1113, 60},
+    {{7, 0, 1, 0}, 1173, 60},
+    {{7, 0, 1, 0}, 1233, 40},
+    {{7, 0, 1, 0}, 1273, 60},
+    {{7, 0, 1, 0}, 1333, 45},
+    {{7, 0, 1, 0}, 1378, 42},
+    {{6, 0, 1, 0}, 1420, 12},
+    {{7, 0, 1, 0}, 1432, 6},
+    {{7, 0, 1, 0}, 1438, 53},
+    {{7, 0, 1, 0}, 1491, 60},
+    {{7, 0, 1, 0}, 1551, 60},
+    {{7, 0, 1, 0}, 1611, 43},
+    {{7, 0, 1, 0}, 1654, 60},
+    {{7, 0, 1, 0}, 1714, 9},
+    {{7, 0, 1, 0}, 1723, 60},
+    {{7, 0, 1, 0}, 1783, 60},
+    {{7, 0, 1, 0}, 1843, 7},
+    {{6, 0, 1, 0}, 1850, 9},
+    {{7, 0, 1, 0}, 1859, 44},
+    {{7, 0, 1, 0}, 1903, 41},
+    {{3, 0, 1, 0}, 1944, 8},
+    {{7, 0, 1, 0}, 1952, 8},
+    {{7, 0, 1, 0}, 1960, 16},
+    {{3, 0, 1, 0}, 1976, 8},
+    {{7, 0, 1, 0}, 1984, 36},
+    {{7, 0, 1, 0}, 2020, 52},
+    {{3, 0, 1, 0}, 2072, 8},
+    {{7, 0, 1, 0}, 2080, 60},
+    {{7, 0, 1, 0}, 2140, 48},
+    {{3, 0, 1, 0}, 2188, 8},
+    {{7, 0, 1, 0}, 2196, 4},
+    {{7, 0, 1, 0}, 2200, 49},
+    {{7, 0, 1, 0}, 2249, 31},
+    {{7, 0, 1, 0}, 2280, 17},
+    {{6, 0, 1, 0}, 2297, 5},
+    {{7, 0, 1, 0}, 2302, 20},
+    {{1, 0, 1, 0}, 2322, 7},
+    {{7, 0, 1, 0}, 2329, 11},
+    {{7, 0, 1, 0}, 2340, 60},
+    {{7, 0, 1, 0}, 2400, 33},
+    {{6, 0, 1, 0}, 2433, 12},
+    {{7, 0, 1, 0}, 2445, 15},
+    {{7, 0, 1, 0}, 2460, 31},
+    {{7, 0, 1, 0}, 2491, 60},
+    {{7, 0, 1, 0}, 2551, 60},
+    {{7, 0, 1, 0}, 2611, 7},
+    {{5, 0, 1, 0}, 2618, 47},
+    {{7, 0, 1, 0}, 2665, 5},
+    {{2, 0, 1, 0}, 2670, 48},
+};
+
+static const uint16_t win_glyphs[] = {
+    32, 32, 84, 104, 101, 32, 32, 104, 101, 97, 100, 32,
+    32, 119, 105, 122, 97, 114, 100, 32, 32, 108, 111, 111,
+    107, 101, 100, 32, 32, 101, 120, 104, 97, 117, 115, 116,
+    101, 100, 46, 32, 72, 105, 115, 32, 32, 98, 101, 97,
+    114, 100, 32, 32, 119, 97, 115, 32, 32, 110, 111, 119,
+    116, 104, 105, 110, 110, 101, 114, 32, 116, 104, 97, 110,
+    32, 116, 104, 97, 110, 32, 119, 104, 101, 110, 32, 104,
+    101, 32, 119, 97, 115, 32, 32, 97, 32, 121, 111, 117,
+    110, 103, 32, 115, 116, 117, 100, 101, 110, 116, 32, 97,
+    116, 32, 116, 104, 101, 32, 119, 105, 122, 97, 114, 100,
+    99, 111, 108, 108, 101, 103, 101, 46, 32, 32, 70, 111,
+    114, 32, 32, 116, 104, 101, 32, 112, 97, 115, 116, 32,
+    32, 102, 101, 119, 32, 32, 100, 97, 121, 115, 32, 32,
+    104, 101, 39, 100, 32, 98, 101, 101, 110, 32, 32, 99,
+    97, 114, 114, 121, 105, 110, 103, 32, 32, 116, 104, 101,
+    97, 114, 116, 105, 102, 97, 99, 116, 32, 97, 99, 114,
+    111, 115, 115, 32, 116, 104, 101, 32, 114, 101, 97, 108,
+    109, 32, 116, 111, 32, 32, 118, 105, 115, 105, 116, 32,
+    101, 97, 99, 104, 32, 97, 110, 100, 32, 101, 118, 101,
+    114, 121, 32, 112, 101, 114, 115, 111, 110, 32, 111, 110,
+    114, 101, 99, 111, 114, 100, 46, 32, 32, 73, 110, 32,
+    115, 111, 109, 101, 32, 32, 99, 97, 115, 101, 115, 32,
+    112, 101, 111, 112, 108, 101, 32, 32, 119, 101, 114, 101,
+    32, 118, 105, 115, 105, 116, 101, 100, 32, 32, 116, 119,
+    105, 99, 101, 32, 111, 114, 32, 32, 101, 118, 101, 110,
+    116, 104, 114, 101, 101, 32, 116, 105, 109, 101, 115, 44,
+    32, 106, 117, 115, 116, 32, 32, 116, 111, 32, 98, 101,
+    32, 97, 98, 115, 111, 108, 117, 116, 101, 108, 121, 32,
+    115, 117, 114, 101, 46, 32, 32, 73, 116, 32, 119, 97,
+    115, 32, 105, 109, 112, 101, 114, 97, 116, 105, 118, 101,
+    116, 104, 97, 116, 32, 110, 111, 32, 111, 110, 101, 32,
+    119, 97, 115, 32, 109, 105, 115, 115, 101, 100, 46, 32,
+    65, 110, 32, 111, 118, 101, 114, 115, 105, 103, 104, 116,
+    32, 99, 111, 117, 108, 100, 32, 99, 111, 115, 116, 32,
+    108, 105, 118, 101, 115, 46, 32, 32, 84, 111, 100, 97,
+    121, 32, 32, 104, 101, 32, 97, 114, 114, 105, 118, 101,
+    100, 32, 32, 97, 116, 32, 32, 97, 32, 115, 109, 97,
+    108, 108, 44, 32, 32, 104, 97, 115, 116, 105, 108, 121,
+    45, 98, 117, 105, 108, 116, 32, 115, 104, 97, 99, 107,
+    46, 32, 32, 84, 104, 101, 114, 101, 99, 111, 114, 100,
+    115, 32, 105, 110, 100, 105, 99, 97, 116, 101, 100, 32,
+    116, 104, 97, 116, 32, 97, 32, 121, 111, 117, 110, 103,
+    32, 99, 111, 117, 112, 108, 101, 32, 108, 105, 118, 101,
+    100, 32, 104, 101, 114, 101, 32, 45, 45, 32, 116, 104,
+    101, 32, 108, 97, 115, 116, 116, 119, 111, 32, 32, 112,
+    101, 111, 112, 108, 101, 32, 119, 104, 111, 32, 32, 119,
+    111, 117, 108, 100, 32, 32, 98, 101, 32, 118, 105, 115,
+    105, 116, 101, 100, 32, 32, 116, 111, 100, 97, 121, 46,
+    32, 32, 73, 102, 32, 116, 104, 101, 32, 32, 102, 105,
+    103, 117, 114, 105, 110, 101, 100, 105, 100, 110, 39, 116,
+    32, 32, 114, 101, 115, 112, 111, 110, 100, 32, 110, 111,
+    119, 44, 32, 32, 116, 104, 101, 32, 32, 105, 110, 118,
+    97, 115, 105, 111, 110, 115, 32, 119, 111, 117, 108, 100,
+    32, 32, 99, 111, 110, 116, 105, 110, 117, 101, 32, 102,
+    111, 114, 32, 32, 97, 116, 108, 101, 97, 115, 116, 32,
+    97, 110, 111, 116, 104, 101, 114, 32, 100, 97, 121, 46,
+    32, 32, 84, 104, 101, 32, 119, 101, 97, 114, 121, 32,
+    32, 111, 108, 100, 32, 119, 105, 122, 97, 114, 100, 32,
+    32, 98, 101, 103, 97, 110, 32, 104, 105, 115, 32, 114,
+    111, 117, 116, 105, 110, 101, 46, 32, 32, 65, 116, 32,
+    116, 104, 101, 32, 32, 100, 111, 111, 114, 32, 104, 101,
+    112, 114, 101, 115, 101, 110, 116, 101, 100, 32, 32, 116,
+    104, 101, 32, 32, 111, 102, 102, 105, 99, 105, 97, 108,
+    44, 32, 32, 115, 116, 97, 109, 112, 101, 100, 32, 100,
+    101, 99, 114, 101, 101, 44, 32, 32, 116, 104, 101, 110,
+    32, 32, 97, 115, 107, 101, 100, 32, 32, 116, 104, 101,
+    98, 101, 119, 105, 108, 100, 101, 114, 101, 100, 32, 99,
+    111, 117, 112, 108, 101, 32, 116, 111, 32, 104, 111, 108,
+    100, 32, 116, 104, 101, 32, 32, 97, 114, 116, 105, 102,
+    97, 99, 116, 46, 32, 70, 105, 114, 115, 116, 32, 116,
+    104, 101, 32, 121, 111, 117, 110, 103, 32, 109, 97, 110,
+    104, 101, 108, 100, 32, 105, 116, 44, 32, 101, 120, 97,
+    109, 105, 110, 105, 110, 103, 32, 105, 116, 46, 32, 32,
+    34, 84, 104, 105, 115, 32, 105, 115, 32, 119, 104, 97,
+    116, 39, 115, 32, 32, 98, 101, 101, 110, 32, 99, 97,
+    117, 115, 105, 110, 103, 32, 97, 108, 108, 32, 116, 104,
+    101, 32, 32, 116, 114, 111, 117, 98, 108, 101, 63, 34,
+    32, 32, 34, 78, 111, 116, 32, 102, 111, 114, 32, 109,
+    117, 99, 104, 32, 108, 111, 110, 103, 101, 114, 44, 34,
+    32, 32, 116, 104, 101, 32, 119, 105, 122, 97, 114, 100,
+    32, 97, 110, 115, 119, 101, 114, 101, 100, 44, 32, 109,
+    117, 109, 98, 108, 105, 110, 103, 32, 34, 46, 46, 46,
+    73, 32, 104, 111, 112, 101, 46, 34, 32, 84, 104, 101,
+    32, 119, 105, 122, 97, 114, 100, 32, 103, 101, 115, 116,
+    117, 114, 101, 100, 32, 102, 111, 114, 32, 116, 104, 101,
+    32, 119, 111, 109, 97, 110, 32, 116, 111, 32, 104, 111,
+    108, 100, 32, 105, 116, 46, 32, 32, 68, 105, 115, 103,
+    117, 115, 116, 101, 100, 44, 32, 104, 97, 110, 100, 105,
+    110, 103, 32, 98, 97, 99, 107, 32, 116, 104, 101, 32,
+    102, 105, 103, 117, 114, 105, 110, 101, 44, 32, 34, 87,
+    104, 111, 32, 119, 111, 117, 108, 100, 32, 109, 97, 107,
+    101, 32, 115, 117, 99, 104, 97, 110, 32, 117, 103, 108,
+    121, 32, 116, 104, 105, 110, 103, 63, 34, 32, 32, 84,
+    104, 101, 32, 119, 105, 122, 97, 114, 100, 32, 104, 101,
+    108, 100, 32, 116, 104, 101, 32, 102, 105, 103, 117, 114,
+    105, 110, 101, 32, 117, 112, 32, 32, 97, 116, 32, 101,
+    121, 101, 32, 108, 101, 118, 101, 108, 44, 32, 103, 105,
+    118, 105, 110, 103, 32, 105, 116, 32, 97, 99, 97, 114,
+    101, 102, 117, 108, 32, 108, 111, 111, 107, 46, 32, 32,
+    68, 105, 100, 32, 97, 110, 121, 116, 104, 105, 110, 103,
+    32, 99, 104, 97, 110, 103, 101, 63, 32, 32, 77, 97,
+    121, 98, 101, 32, 105, 116, 32, 102, 101, 108, 116, 32,
+    32, 97, 32, 108, 105, 116, 116, 108, 101, 108, 105, 103,
+    104, 116, 101, 114, 63, 32, 78, 111, 116, 104, 105, 110,
+    103, 32, 115, 101, 101, 109, 101, 100, 32, 116, 111, 32,
+    98, 101, 32, 100, 105, 102, 102, 101, 114, 101, 110, 116,
+    46, 32, 32, 34, 65, 110, 111, 116, 104, 101, 114, 32,
+    100, 97, 121, 44, 34, 32, 32, 104, 101, 32, 115, 105,
+    103, 104, 101, 100, 44, 32, 98, 117, 116, 32, 119, 97,
+    115, 32, 32, 105, 110, 116, 101, 114, 114, 117, 112, 116,
+    101, 100, 32, 98, 121, 32, 99, 114, 121, 105, 110, 103,
+    46, 80, 117, 115, 104, 105, 110, 103, 32, 104, 105, 115,
+    32, 119, 97, 121, 32, 105, 110, 116, 111, 32, 116, 104,
+    101, 32, 104, 111, 109, 101, 44, 32, 34, 87, 104, 97,
+    116, 39, 115, 32, 116, 104, 97, 116, 63, 34, 32, 32,
+    84, 104, 101, 32, 119, 111, 109, 97, 110, 32, 97, 110,
+    115, 119, 101, 114, 101, 100, 32, 115, 109, 105, 108, 105,
+    110, 103, 44, 32, 34, 84, 104, 97, 116, 39, 115, 32,
+    111, 117, 114, 32, 110, 101, 119, 98, 111, 114, 110, 32,
+    103, 105, 114, 108, 46, 32, 74, 117, 115, 116, 116, 119,
+    111, 32, 100, 97, 121, 115, 32, 97, 103, 111, 46, 32,
+    87, 101, 32, 104, 97, 118, 101, 110, 39, 116, 32, 101,
+    118, 101, 110, 32, 112, 105, 99, 107, 101, 100, 32, 111,
+    117, 116, 32, 97, 32, 110, 97, 109, 101, 32, 121, 101,
+    116, 46, 34, 32, 32, 84, 104, 101, 32, 119, 105, 122,
+    97, 114, 100, 32, 113, 117, 105, 99, 107, 108, 121, 32,
+    112, 117, 108, 108, 101, 100, 32, 111, 117, 116, 32, 32,
+    104, 105, 115, 32, 114, 101, 99, 111, 114, 100, 115, 46,
+    32, 34, 84, 104, 97, 116, 39, 115, 32, 110, 111, 116,
+    32, 111, 110, 114, 101, 99, 111, 114, 100, 44, 32, 98,
+    117, 116, 32, 32, 116, 104, 105, 115, 32, 115, 99, 114,
+    111, 108, 108, 32, 105, 115, 32, 32, 112, 114, 111, 98,
+    97, 98, 108, 121, 32, 97, 32, 99, 111, 117, 112, 108,
+    101, 32, 111, 102, 32, 32, 100, 97, 121, 115, 32, 111,
+    108, 100, 46, 87, 104, 121, 32, 100, 105, 100, 110, 39,
+    116, 32, 121, 111, 117, 32, 109, 101, 110, 116, 105, 111,
+    110, 32, 104, 101, 114, 32, 119, 104, 101, 110, 32, 73,
+    32, 97, 114, 114, 105, 118, 101, 100, 63, 34, 32, 32,
+    84, 104, 101, 32, 99, 111, 117, 112, 108, 101, 32, 103,
+    108, 97, 110, 99, 101, 100, 32, 97, 116, 32, 101, 97,
+    99, 104, 32, 111, 116, 104, 101, 114, 46, 32, 34, 87,
+    101, 32, 100, 105, 100, 110, 39, 116, 32, 107, 110, 111,
+    119, 32, 99, 104, 105, 108, 100, 114, 101, 110, 99, 111,
+    117, 110, 116, 101, 100, 46, 34, 32, 32, 84, 104, 101,
+    32, 119, 105, 122, 97, 114, 100, 32, 32, 102, 114, 111,
+    119, 110, 101, 100, 32, 97, 110, 100, 32, 99, 111, 110,
+    116, 105, 110, 117, 101, 100, 32, 98, 97, 99, 107, 32,
+    32, 116, 111, 119, 97, 114, 100, 115, 32, 116, 104, 101,
+    32, 115, 111, 117, 114, 99, 101, 111, 102, 32, 32, 116,
+    104, 101, 32, 99, 114, 121, 105, 110, 103, 46, 32, 32,
+    73, 110, 32, 97, 110, 32, 32, 111, 118, 101, 114, 115,
+    105, 122, 101, 100, 32, 99, 114, 105, 98, 32, 32, 104,
+    101, 32, 115, 97, 119, 32, 32, 116, 104, 101, 32, 115,
+    109, 97, 108, 108, 101, 115, 116, 108, 105, 116, 116, 108,
+    101, 32, 98, 97, 98, 121, 32, 103, 105, 114, 108, 44,
+    32, 104, 101, 114, 32, 116, 105, 110, 121, 32, 32, 108,
+    105, 116, 116, 108, 101, 32, 104, 97, 110, 100, 115, 32,
+    103, 114, 97, 115, 112, 105, 110, 103, 32, 97, 116, 32,
+    116, 104, 101, 32, 97, 105, 114, 97, 98, 111, 118, 101,
+    46, 32, 83, 104, 101, 32, 119, 97, 115, 32, 97, 108,
+    109, 111, 115, 116, 32, 110, 111, 32, 98, 105, 103, 103,
+    101, 114, 32, 116, 104, 97, 110, 32, 116, 104, 101, 32,
+    102, 105, 103, 117, 114, 105, 110, 101, 32, 105, 116, 115,
+    101, 108, 102, 46, 32, 32, 72, 101, 32, 32, 104, 101,
+    108, 100, 32, 116, 104, 101, 32, 32, 102, 105, 103, 117,
+    114, 105, 110, 101, 32, 116, 111, 119, 97, 114, 100, 115,
+    32, 32, 104, 101, 114, 32, 97, 110, 100, 32, 32, 115,
+    104, 101, 32, 105, 110, 115, 116, 105, 110, 99, 116, 105,
+    118, 101, 108, 121, 103, 114, 97, 98, 98, 101, 100, 32,
+    97, 116, 32, 32, 105, 116, 46, 32, 65, 115, 32, 32,
+    115, 111, 111, 110, 32, 97, 115, 32, 115, 104, 101, 32,
+    32, 109, 97, 100, 101, 32, 99, 111, 110, 116, 97, 99,
+    116, 44, 32, 32, 116, 104, 101, 32, 102, 105, 103, 117,
+    114, 105, 110, 101, 102, 108, 97, 115, 104, 101, 100, 32,
+    97, 115, 32, 98, 114, 105, 103, 104, 116, 32, 32, 97,
+    115, 32, 116, 104, 101, 32, 115, 117, 110, 44, 32, 99,
+    97, 117, 115, 105, 110, 103, 32, 116, 104, 101, 32, 32,
+    119, 105, 122, 97, 114, 100, 32, 116, 111, 32, 97, 108,
+    109, 111, 115, 116, 100, 114, 111, 112, 32, 105, 116, 46,
+    32, 74, 117, 115, 116, 32, 32, 97, 115, 32, 102, 97,
+    115, 116, 44, 32, 116, 104, 101, 32, 108, 105, 103, 104,
+    116, 32, 115, 116, 111, 112, 112, 101, 100, 46, 32, 32,
+    84, 104, 101, 32, 102, 105, 103, 117, 114, 105, 110, 101,
+    32, 104, 97, 100, 116, 114, 97, 110, 115, 102, 111, 114,
+    109, 101, 100, 32, 102, 114, 111, 109, 32, 111, 98, 115,
+    105, 100, 105, 97, 110, 32, 105, 110, 116, 111, 32, 115,
+    111, 109, 101, 32, 115, 111, 114, 116, 32, 111, 102, 32,
+    111, 112, 97, 108, 46, 32, 32, 32, 32, 32, 32, 32,
+    32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32,
+    32, 32, 32, 32, 32, 32, 32, 32, 32, 46, 46, 46,
+    32, 32, 87, 105, 116, 104, 105, 110, 32, 104, 111, 117,
+    114, 115, 44, 32, 32, 71, 45, 67, 79, 77, 32, 114,
+    101, 112, 111, 114, 116, 101, 100, 32, 116, 104, 97, 116,
+    32, 116, 104, 101, 32, 32, 103, 111, 98, 108, 105, 110,
+    115, 32, 101, 118, 101, 114, 121, 119, 104, 101, 114, 101,
+    119, 101, 114, 101, 32, 99, 111, 110, 102, 117, 115, 101,
+    100, 32, 97, 110, 100, 32, 102, 108, 101, 101, 105, 110,
+    103, 46, 32, 67, 101, 108, 101, 98, 114, 97, 116, 105,
+    111, 110, 115, 32, 98, 101, 103, 97, 110, 32, 101, 118,
+    101, 114, 121, 119, 104, 101, 114, 101, 46, 32, 73, 116,
+    119, 97, 115, 32, 102, 105, 110, 97, 108, 108, 121, 32,
+    111, 118, 101, 114, 46, 32, 84, 104, 101, 32, 116, 111,
+    117, 99, 104, 32, 111, 102, 32, 97, 32, 110, 101, 119,
+    98, 111, 114, 110, 32, 98, 97, 98, 121, 32, 101, 110,
+    100, 101, 100, 32, 116, 104, 101, 32, 119, 97, 114, 46,
+    32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32,
+    32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32,
+    32, 32, 32, 32, 46, 46, 46, 32, 32, 87, 104, 97,
+    116, 32, 119, 111, 117, 108, 100, 32, 110, 111, 119, 32,
+    104, 97, 112, 112, 101, 110, 32, 116, 111, 32, 116, 104,
+    101, 32, 111, 112, 97, 108, 32, 97, 114, 116, 105, 102,
+    97, 99, 116, 63, 32, 73, 116, 32, 119, 97, 115, 32,
+    100, 101, 99, 105, 100, 101, 100, 116, 104, 97, 116, 32,
+    32, 105, 116, 32, 115, 104, 111, 117, 108, 100, 32, 32,
+    98, 101, 32, 114, 101, 116, 117, 114, 110, 101, 100, 32,
+    32, 116, 111, 32, 32, 116, 104, 101, 32, 100, 117, 110,
+    103, 101, 111, 110, 32, 32, 119, 104, 101, 114, 101, 32,
+    105, 116, 32, 32, 119, 97, 115, 102, 111, 117, 110, 100,
+    46, 32, 65, 108, 108, 32, 116, 104, 97, 116, 32, 119,
+    97, 115, 32, 110, 101, 101, 100, 101, 100, 32, 119, 97,
+    115, 32, 97, 32, 98, 114, 97, 118, 101, 32, 114, 111,
+    103, 117, 101, 32, 116, 111, 32, 100, 111, 32, 105, 116,
+    46, 32, 32, 32, 32, 32, 91, 83, 101, 101, 32, 116,
+    104, 101, 32, 115, 116, 111, 114, 121, 32, 99, 111, 110,
+    116, 105, 110, 117, 101, 32, 110, 101, 120, 116, 32, 121,
+    101, 97, 114, 32, 105, 110, 32, 55, 68, 82, 76, 32,
+    50, 48, 49, 54, 33, 93,
+};
+
+const text_t text_win = {
+    68, win_line, win_runs, win_glyphs
+};
+
+static const uint16_t apology_line[] = {
+    0, 3, 3, 4, 5, 6, 7, 8, 9, 9, 10, 11,
+    12, 13, 13, 14, 16,
+};
+
+static const struct text_run apology_runs[] = {
+    {{7, 0, 1, 0}, 0, 15},
+    {{2, 0, 1, 0}, 15, 29},
+    {{7, 0, 1, 0}, 44, 16},
+    {{7, 0, 1, 0}, 60, 60},
+    {{7, 0, 1, 0}, 120, 60},
+    {{7, 0, 1, 0}, 180, 60},
+    {{7, 0, 1, 0}, 240, 60},
+    {{7, 0, 1, 0}, 300, 60},
+    {{7, 0, 1, 0}, 360, 15},
+    {{7, 0, 1, 0}, 375, 60},
+    {{7, 0, 1, 0}, 435, 60},
+    {{7, 0, 1, 0}, 495, 60},
+    {{7, 0, 1, 0}, 555, 30},
+    {{7, 0, 1, 0}, 585, 60},
+    {{5, 0, 1, 0}, 645, 28},
+    {{7, 0, 1, 0}, 673, 28},
+};
+
+static const uint16_t apology_glyphs[] = {
+    9500, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472,
+    9472, 9472, 32, 65, 110, 32, 65, 112, 111, 108, 111, 103,
+    121, 32, 102, 114, 111, 109, 32, 116, 104, 101, 32, 68,
+    101, 118, 101, 108, 111, 112, 101, 114, 32, 9472, 9472, 9472,
+    9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9472, 9508,
+    32, 32, 84, 104, 101, 114, 101, 32, 119, 97, 115, 32,
+    32, 115, 117, 112, 112, 111, 115, 101, 100, 32, 116, 111,
+    32, 98, 101, 32, 32, 97, 32, 98, 97, 116, 116, 108,
+    101, 115, 99, 97, 112, 101, 32, 116, 104, 105, 110, 103,
+    32, 32, 104, 101, 114, 101, 32, 119, 104, 101, 114, 101,
+    121, 111, 117, 32, 102, 105, 103, 104, 116, 32, 116, 104,
+    101, 32, 103, 111, 98, 108, 105, 110, 115, 32, 105, 110,
+    32, 32, 116, 117, 114, 110, 45, 98, 97, 115, 101, 100,
+    32, 98, 97, 116, 116, 108, 101, 44, 32, 88, 45, 67,
+    79, 77, 32, 115, 116, 121, 108, 101, 46, 32, 65, 115,
+    117, 115, 117, 97, 108, 32, 32, 102, 111, 114, 32, 55,
+    68, 82, 76, 44, 32, 32, 116, 104, 97, 116, 32, 32,
+    119, 97, 115, 32, 32, 116, 111, 111, 32, 97, 109, 98,
+    105, 116, 105, 111, 117, 115, 32, 32, 102, 111, 114, 32,
+    32, 97, 32, 111, 110, 101, 32, 32, 119, 101, 101, 107,
+    112, 114, 111, 106, 101, 99, 116, 44, 32, 115, 111, 32,
+    105, 116, 32, 119, 97, 115, 32, 99, 117, 116, 46, 32,
+    73, 39, 100, 32, 32, 108, 105, 107, 101, 32, 116, 111,
+    32, 102, 105, 110, 105, 115, 104, 32, 116, 104, 105, 115,
+    32, 112, 97, 114, 116, 32, 105, 110, 32, 116, 104, 101,
+    102, 117, 116, 117, 114, 101, 44, 32, 111, 117, 116, 115,
+    105, 100, 101, 32, 111, 102, 32, 55, 68, 82, 76, 44,
+    32, 115, 111, 32, 99, 104, 101, 99, 107, 32, 32, 98,
+    97, 99, 107, 32, 115, 111, 109, 101, 32, 111, 116, 104,
+    101, 114, 32, 116, 105, 109, 101, 32, 105, 110, 32, 97,
+    102, 117, 116, 117, 114, 101, 32, 118, 101, 114, 115, 105,
+    111, 110, 46, 32, 32, 73, 110, 115, 116, 101, 97, 100,
+    44, 32, 32, 98, 97, 116, 116, 108, 101, 115, 32, 32,
+    97, 114, 101, 32, 32, 114, 101, 115, 111, 108, 118, 101,
+    100, 32, 32, 97, 117, 116, 111, 109, 97, 116, 105, 99,
+    97, 108, 108, 121, 32, 32, 102, 114, 111, 109, 32, 121,
+    111, 117, 114, 104, 101, 114, 111, 101, 115, 39, 32, 32,
+    115, 116, 97, 116, 115, 46, 32, 72, 101, 114, 111, 101,
+    115, 32, 99, 97, 110, 32, 102, 97, 108, 108, 44, 32,
+    97, 110, 100, 32, 97, 32, 115, 113, 117, 97, 100, 32,
+    116, 104, 97, 116, 32, 99, 97, 110, 39, 116, 32, 98,
+    101, 97, 116, 116, 104, 101, 32, 32, 103, 111, 98, 108,
+    105, 110, 115, 32, 102, 97, 108, 108, 115, 32, 98, 97,
+    99, 107, 32, 116, 111, 32, 116, 104, 101, 32, 99, 97,
+    115, 116, 108, 101, 44, 32, 119, 104, 101, 114, 101, 32,
+    104, 101, 114, 111, 101, 115, 32, 114, 101, 115, 116, 32,
+    97, 110, 100, 104, 101, 97, 108, 46, 32, 75, 101, 101,
+    112, 32, 121, 111, 117, 114, 32, 115, 113, 117, 97, 100,
+    115, 32, 115, 116, 114, 111, 110, 103, 33, 32, 32, 84,
+    104, 101, 114, 101, 39, 115, 32, 32, 115, 116, 105, 108,
+    108, 32, 97, 32, 32, 115, 116, 111, 114, 121, 44, 32,
+    116, 104, 111, 117, 103, 104, 44, 32, 32, 115, 111, 32,
+    107, 101, 101, 112, 32, 32, 112, 108, 97, 121, 105, 110,
+    103, 46, 32, 40, 72, 105, 110, 116, 58, 107, 101, 101,
+    112, 32, 103, 114, 111, 119, 105, 110, 103, 32, 121, 111,
+    117, 114, 32, 112, 111, 112, 117, 108, 97, 116, 105, 111,
+    110, 32, 119, 104, 105, 108, 101, 32, 102, 101, 110, 100,
+    105, 110, 103, 32, 111, 102, 102, 32, 103, 111, 98, 108,
+    105, 110, 115, 46, 41,
+};
+
+const text_t text_apology = {
+    16, apology_line, apology_runs, apology_glyphs
+};